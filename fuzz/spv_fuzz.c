@@ -0,0 +1,203 @@
+/*
+ *    spv_fuzz.c    --    Fuzzing harness for the SPV library
+ *
+ *    This file is part of the SPV library.
+ *
+ *    This file defines a libFuzzer entry point for spv_parse, spv_export,
+ *    spv_estimate_cost and spv_swap_endian, along with a standalone driver
+ *    that can be used with AFL or to measure throughput.
+ *
+ *    libFuzzer:
+ *        clang -g -O1 -fsanitize=fuzzer,address -I.. spv_fuzz.c ../spvlib.c -o spv_fuzz
+ *        ./spv_fuzz corpus
+ *
+ *    AFL:
+ *        afl-clang-fast -DSPV_FUZZ_STANDALONE -I.. spv_fuzz.c ../spvlib.c -o spv_fuzz
+ *        afl-fuzz -i corpus -o findings ./spv_fuzz @@
+ *
+ *    Throughput, of spv_parse alone with -p, or of the whole harness without:
+ *        cc -O2 -DSPV_FUZZ_STANDALONE -I.. spv_fuzz.c ../spvlib.c -o spv_fuzz
+ *        ./spv_fuzz -p -n 10000 corpus/minimal.spv corpus/reflection.spv
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "spvlib.h"
+
+/*
+ *    Exports a module in both formats into one buffer.
+ *
+ *    @param spv_t *spv              The module to export.
+ *    @param spv_buffer_t *buffer    The buffer to append to.
+ */
+static void spv_fuzz_export(spv_t *spv, spv_buffer_t *buffer) {
+    spv_export(spv, _EXPORT_TEXT, buffer);
+    spv_export(spv, _EXPORT_JSON, buffer);
+}
+
+/*
+ *    Parses one input and exercises the queries on the result.
+ *
+ *    @param const unsigned char *data    The input to parse.
+ *    @param size_t size                  The size of the input.
+ *
+ *    @return int    Always 0.
+ */
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size) {
+    /* Copy into a fresh allocation so word reads are aligned and overreads are caught.  */
+    char *copy = (char *)malloc(size ? size : 1);
+
+    if (copy == (char *)0x0)
+        return 0;
+
+    memcpy(copy, data, size);
+
+    spv_t      *spv  = spv_parse(copy, size);
+    spv_cost_t *cost = spv_estimate_cost(copy, size);
+
+    if (cost != (spv_cost_t *)0x0)
+        spv_free_cost(cost);
+
+    if (spv != (spv_t *)0x0) {
+        unsigned int inputs   = spv_get_input_count(spv);
+        unsigned int uniforms = spv_get_uniform_count(spv);
+
+        for (unsigned int i = 0; i < inputs; ++i) {
+            spv_get_input_type(spv, i);
+        }
+
+        for (unsigned int i = 0; i < uniforms; ++i) {
+            spv_get_uniform_type(spv, i);
+        }
+
+        spv_memory_usage(spv);
+    }
+
+    /* A swapped module must read the same once converted to host order.  */
+    if (spv_swap_endian(copy, size)) {
+        spv_t *host = spv_parse(copy, size);
+
+        if (spv != (spv_t *)0x0 && host != (spv_t *)0x0) {
+            spv_buffer_t swapped = { (char *)0x0, 0, 0 };
+            spv_buffer_t native  = { (char *)0x0, 0, 0 };
+
+            spv_fuzz_export(spv, &swapped);
+            spv_fuzz_export(host, &native);
+
+            if (swapped.size != native.size || (native.size != 0 && memcmp(swapped.data, native.data, native.size) != 0))
+                abort();
+
+            free(swapped.data);
+            free(native.data);
+        }
+
+        if (host != (spv_t *)0x0)
+            spv_free(host);
+    }
+    else if (spv != (spv_t *)0x0) {
+        spv_buffer_t buffer = { (char *)0x0, 0, 0 };
+
+        spv_fuzz_export(spv, &buffer);
+        free(buffer.data);
+    }
+
+    if (spv != (spv_t *)0x0)
+        spv_free(spv);
+
+    free(copy);
+
+    return 0;
+}
+
+#ifdef SPV_FUZZ_STANDALONE
+/*
+ *    Reads a whole file into memory.
+ *
+ *    @param const char *path       The path of the file.
+ *    @param unsigned long *size    Set to the size of the file.
+ *
+ *    @return char *    The file contents, or null on failure.
+ */
+static char *spv_fuzz_read(const char *path, unsigned long *size) {
+    FILE *file = fopen(path, "rb");
+
+    if (file == (FILE *)0x0)
+        return (char *)0x0;
+
+    fseek(file, 0, SEEK_END);
+
+    *size = ftell(file);
+
+    fseek(file, 0, SEEK_SET);
+
+    char *data = (char *)malloc(*size ? *size : 1);
+
+    if (data != (char *)0x0 && fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = (char *)0x0;
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+int main(int argc, char **argv) {
+    unsigned long iterations = 1;
+    int           parse_only = 0;
+    int           first      = 1;
+
+    for (; first < argc && argv[first][0] == '-'; ++first) {
+        if (strcmp(argv[first], "-p") == 0) {
+            parse_only = 1;
+        } else if (strcmp(argv[first], "-n") == 0 && first + 1 < argc) {
+            iterations = strtoul(argv[++first], (char **)0x0, 10);
+        } else {
+            fprintf(stderr, "usage: %s [-p] [-n iterations] input ...\n", argv[0]);
+            return 1;
+        }
+    }
+
+    unsigned long long bytes = 0;
+    struct timespec    start;
+    struct timespec    end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = first; i < argc; ++i) {
+        unsigned long size = 0;
+        char         *data = spv_fuzz_read(argv[i], &size);
+
+        if (data == (char *)0x0) {
+            fprintf(stderr, "Failed to read %s\n", argv[i]);
+            continue;
+        }
+
+        for (unsigned long j = 0; j < iterations; ++j) {
+            if (parse_only) {
+                spv_t *spv = spv_parse(data, size);
+
+                if (spv != (spv_t *)0x0)
+                    spv_free(spv);
+            } else {
+                LLVMFuzzerTestOneInput((const unsigned char *)data, size);
+            }
+        }
+
+        bytes += (unsigned long long)size * iterations;
+
+        free(data);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (iterations > 1 && seconds > 0.0)
+        printf("%llu bytes in %.3fs, %.1f MB/s\n", bytes, seconds, bytes / seconds / 1e6);
+
+    return 0;
+}
+#endif /* SPV_FUZZ_STANDALONE  */
@@ -9,32 +9,234 @@
  */
 #include "spvlib.h"
 
-#define _OP_NOP                0
-#define _OP_NAME               5
-#define _OP_MEMBER_NAME        6
-#define _OP_TYPE_FLOAT         22
-#define _OP_TYPE_VECTOR        23
-#define _OP_TYPE_IMAGE         25
-#define _OP_TYPE_SAMPLED_IMAGE 27
-#define _OP_TYPE_POINTER       32
-#define _OP_VARIABLE           59
-#define _OP_DECORATE           71
-#define _OP_MEMBER_DECORATE    72
-
-#define _DEC_BLOCK          2
-#define _DEC_BUILTIN        11
-#define _DEC_LOCATION       30
-#define _DEC_OFFSET         35
-
-#define _PARSE(buf, type, pos) (*(type *)(buf + pos)); pos += sizeof(type)
+#define _OP_NOP                   0
+#define _OP_NAME                  5
+#define _OP_MEMBER_NAME           6
+#define _OP_LINE                  8
+#define _OP_EXT_INST_IMPORT       11
+#define _OP_EXT_INST              12
+#define _OP_TYPE_FLOAT            22
+#define _OP_TYPE_VECTOR           23
+#define _OP_TYPE_IMAGE            25
+#define _OP_TYPE_SAMPLED_IMAGE    27
+#define _OP_TYPE_POINTER          32
+#define _OP_FUNCTION              54
+#define _OP_FUNCTION_END          56
+#define _OP_VARIABLE              59
+#define _OP_LOAD                  61
+#define _OP_STORE                 62
+#define _OP_COPY_MEMORY           63
+#define _OP_COPY_MEMORY_SIZED     64
+#define _OP_DECORATE              71
+#define _OP_MEMBER_DECORATE       72
+#define _OP_VECTOR_SHUFFLE        79
+#define _OP_TRANSPOSE             84
+#define _OP_IMAGE_SAMPLE_FIRST    87
+#define _OP_IMAGE_READ            98
+#define _OP_IMAGE_WRITE           99
+#define _OP_ALU_FIRST             109
+#define _OP_ALU_LAST              215
+#define _OP_CONTROL_BARRIER       224
+#define _OP_MEMORY_BARRIER        225
+#define _OP_ATOMIC_LOAD           227
+#define _OP_ATOMIC_STORE          228
+#define _OP_ATOMIC_LAST           242
+#define _OP_LOOP_MERGE            246
+#define _OP_SELECTION_MERGE       247
+#define _OP_LABEL                 248
+#define _OP_BRANCH                249
+#define _OP_BRANCH_CONDITIONAL    250
+#define _OP_SWITCH                251
+#define _OP_KILL                  252
+#define _OP_RETURN                253
+#define _OP_RETURN_VALUE          254
+#define _OP_UNREACHABLE           255
+#define _OP_IMAGE_SPARSE_FIRST    305
+#define _OP_IMAGE_SPARSE_LAST     315
+#define _OP_NO_LINE               317
+
+#define _EXPORT_MAX_DEPTH   16
+#define _EXPORT_CHUNK       65536
+#define _EXPORT_MAX_SIZE    (16 * 1024 * 1024)
+
+#define _COST_MAX_LOOPS     16
+#define _COST_LOOP_SHIFT    2
+
+#define _MAGIC         0x07230203
+#define _MAGIC_SWAPPED 0x03022307
+
+/* The universal limit on the id bound from the SPIR-V spec.  */
+#define _MAX_ID_BOUND  4194303
+
+#define _PARSE_WORD(buf, pos, swapped) spv_word(buf, pos, swapped); pos += sizeof(unsigned int)
+#define _OPERAND(buf, pos, i, swapped) spv_word(buf, (pos) + (i) * sizeof(unsigned int), swapped)
 
 #include <stdlib.h>
 #include <stdio.h>
-
-const char *spv_current_error = "";
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define _THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define _THREAD_LOCAL __thread
+#else
+#define _THREAD_LOCAL
+#endif
+
+/* Per thread, so modules can be parsed concurrently, as spvload.c does.  */
+_THREAD_LOCAL const char *spv_current_error = "";
 
 void (*spv_error_callback)(const char *) = (void (*)(const char *))0x0;
 
+/*
+ *    Reverses the byte order of a word.
+ *
+ *    @param unsigned int word    The word to swap.
+ *
+ *    @return unsigned int    The swapped word.
+ */
+static inline unsigned int spv_bswap(unsigned int word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(word);
+#else
+    return (word >> 24) | ((word >> 8) & 0xFF00) | ((word << 8) & 0xFF0000) | (word << 24);
+#endif
+}
+
+/*
+ *    Reads a word of a module, swapping it if the module is byte-swapped.
+ *
+ *    @param const char *data       The spirv binary data.
+ *    @param unsigned long pos      The position of the word.
+ *    @param int swapped            Whether the module is byte-swapped.
+ *
+ *    @return unsigned int    The word in host order.
+ */
+static inline unsigned int spv_word(const char *data, unsigned long pos, int swapped) {
+    unsigned int word = *(const unsigned int *)(data + pos);
+
+    return swapped ? spv_bswap(word) : word;
+}
+
+typedef struct {
+    spv_t         *spv;
+    spv_buffer_t  *buffer;
+    int            fd;
+    int            failed;
+    int            truncated;
+    unsigned long  written;
+    unsigned int  *type_index;
+    unsigned long  type_index_size;
+    unsigned char *struct_state;
+    unsigned int  *structs;
+    unsigned long  structs_size;
+} _writer_t;
+
+typedef struct {
+    unsigned long *def;
+    unsigned long *last;
+    unsigned long  ids_size;
+    unsigned int  *defs;
+    unsigned long  defs_size;
+    unsigned long  defs_capacity;
+    unsigned long  start;
+    unsigned long  position;
+} _cost_state_t;
+
+static const unsigned int spv_cost_weights[_COST_COUNT] = { 1, 4, 8, 4, 4, 8, 2, 0 };
+
+#ifdef SPV_ENABLE_STATS
+#include <time.h>
+
+/* Per thread, like spv_current_error, so each thread only sees the modules it parses.  */
+_THREAD_LOCAL spv_stats_t *spv_stats = (spv_stats_t *)0x0;
+
+/*
+ *    Sets the stats struct that spv_parse fills in on the calling thread.
+ *    The struct is reset at the start of every parse, pass a null pointer
+ *    to stop collecting.
+ *
+ *    @param spv_stats_t *stats    The stats struct to fill, or null.
+ */
+void spv_set_stats(spv_stats_t *stats) {
+    spv_stats = stats;
+}
+
+/*
+ *    Gets the current monotonic time.
+ *
+ *    @return unsigned long long    The time in nanoseconds.
+ */
+static unsigned long long spv_stats_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*
+ *    Gets the logical module section an instruction belongs to.
+ *
+ *    @param unsigned short opcode     The opcode of the instruction.
+ *    @param _section_e current        The section of the previous instruction.
+ *
+ *    @return _section_e    The section of the instruction.
+ */
+static _section_e spv_stats_section(unsigned short opcode, _section_e current) {
+    /* Everything after the first function belongs to the function bodies.  */
+    if (current == _SECTION_FUNCTIONS || opcode == 54)
+        return _SECTION_FUNCTIONS;
+
+    if (opcode >= 10 && opcode <= 17)
+        return _SECTION_PREAMBLE;
+
+    if (opcode >= 1 && opcode <= 7)
+        return _SECTION_DEBUG;
+
+    if (opcode >= 71 && opcode <= 75)
+        return _SECTION_ANNOTATIONS;
+
+    if ((opcode >= 19 && opcode <= 52) || opcode == _OP_VARIABLE)
+        return _SECTION_GLOBALS;
+
+    return current;
+}
+
+/*
+ *    Records an allocation made on behalf of a spv_t struct.
+ *
+ *    @param void *ptr            The old pointer, as passed to realloc.
+ *    @param unsigned long size   The size of the allocation.
+ *
+ *    @return void *    The allocated memory.
+ */
+static void *spv_stats_realloc(void *ptr, unsigned long size) {
+    if (spv_stats != (spv_stats_t *)0x0) {
+        spv_stats->allocations++;
+        spv_stats->allocation_bytes += size;
+    }
+
+    return realloc(ptr, size);
+}
+
+#define _REALLOC(ptr, size) spv_stats_realloc(ptr, size)
+#define _MALLOC(size)       spv_stats_realloc((void *)0x0, size)
+#else
+#define _REALLOC(ptr, size) realloc(ptr, size)
+#define _MALLOC(size)       malloc(size)
+#endif /* SPV_ENABLE_STATS  */
+
 /*
  *    Sets the error callback function.
  *
@@ -53,16 +255,88 @@ const char *spv_get_last_error(void) {
     return spv_current_error;
 }
 
+/*
+ *    Reports a parse error and frees a partially parsed spv_t struct.
+ *
+ *    @param spv_t *spv           The spv_t struct to free, or null.
+ *    @param const char *error    The error message.
+ *
+ *    @return spv_t *    Always null.
+ */
+static spv_t *spv_fail(spv_t *spv, const char *error) {
+    if (spv != (spv_t *)0x0)
+        spv_free(spv);
+
+    spv_current_error = error;
+    if (spv_error_callback != (void (*)(const char *))0x0)
+        spv_error_callback(spv_current_error);
+
+    return (spv_t *)0x0;
+}
+
+/*
+ *    Copies a literal string operand out of an instruction.
+ *
+ *    @param const char *data        The spirv binary data.
+ *    @param unsigned long pos       The position of the string.
+ *    @param unsigned long words     The number of words the string may span.
+ *    @param int swapped             Whether the module is byte-swapped.
+ *
+ *    @return char *    The null terminated string, or null on failure.
+ */
+static char *spv_parse_string(const char *data, unsigned long pos, unsigned long words, int swapped) {
+    /* Strings are packed little-endian within each word, so a swapped module reverses every four bytes.  */
+    unsigned long flip   = swapped ? 3 : 0;
+    unsigned long length = 0;
+
+    while (length < words * sizeof(unsigned int) && data[pos + (length ^ flip)] != '\0')
+        length++;
+
+    char *str = (char *)_MALLOC(length + 1);
+
+    if (str == (char *)0x0)
+        return str;
+
+    for (unsigned long i = 0; i < length; ++i)
+        str[i] = data[pos + (i ^ flip)];
+
+    str[length] = '\0';
+
+    return str;
+}
+
 /*
  *    Parses spirv binary data into a spv_t struct.
  *
+ *    Every instruction's word count is checked against the words left in
+ *    the buffer before any of its operands are read, so malformed or
+ *    truncated modules are rejected instead of being read out of bounds.
+ *
  *    @param const char *data    The spirv binary data to parse.
  *    @param unsigned long size  The size of the spirv binary data.
  * 
  *    @return spv_t *            A pointer to the parsed spirv data.
  */
 spv_t *spv_parse(const char *data, unsigned long size) {
-    spv_t *spv = (spv_t *)malloc(sizeof(spv_t));
+#ifdef SPV_ENABLE_STATS
+    _section_e         section       = _SECTION_PREAMBLE;
+    unsigned long long section_start = 0;
+
+    if (spv_stats != (spv_stats_t *)0x0) {
+        memset(spv_stats, 0, sizeof(spv_stats_t));
+        section_start = spv_stats_now();
+    }
+#endif /* SPV_ENABLE_STATS  */
+
+    if (size < 5 * sizeof(unsigned int) || size % sizeof(unsigned int) != 0) {
+        return spv_fail((spv_t *)0x0, "Invalid module size.");
+    }
+
+    spv_t *spv = (spv_t *)_MALLOC(sizeof(spv_t));
+
+    if (spv == (spv_t *)0x0) {
+        return spv_fail(spv, "Failed to allocate memory for module.");
+    }
 
     spv->types            = (_type_t *)0x0;
     spv->types_size       = 0;
@@ -75,27 +349,60 @@ spv_t *spv_parse(const char *data, unsigned long size) {
     spv->names            = (_name_t *)0x0;
     spv->names_size       = 0;
 
-    unsigned long pos = 0;
+    spv->member_decorations      = (_member_decoration_t *)0x0;
+    spv->member_decorations_size = 0;
+    spv->member_names            = (_member_name_t *)0x0;
+    spv->member_names_size       = 0;
+    spv->bound                   = 0;
 
-    unsigned int magic      = _PARSE(data, unsigned int, pos);
-    unsigned int version    = _PARSE(data, unsigned int, pos);
-    unsigned int generator  = _PARSE(data, unsigned int, pos);
-    unsigned int bound      = _PARSE(data, unsigned int, pos);
-    unsigned int schema     = _PARSE(data, unsigned int, pos);
+    unsigned long pos = 0;
 
-    if (magic != 0x07230203) {
-        free(spv);
+    /* Modules serialized on big-endian hosts are read as they are, swapping each word on load.  */
+    int          swapped    = *(const unsigned int *)data == _MAGIC_SWAPPED;
 
-        spv_current_error = "Invalid magic number.";
-        if (spv_error_callback != (void (*)(const char *))0x0)
-            spv_error_callback(spv_current_error);
+    unsigned int magic      = _PARSE_WORD(data, pos, swapped);
+    unsigned int version    = _PARSE_WORD(data, pos, swapped);
+    unsigned int generator  = _PARSE_WORD(data, pos, swapped);
+    unsigned int bound      = _PARSE_WORD(data, pos, swapped);
+    unsigned int schema     = _PARSE_WORD(data, pos, swapped);
 
-        return (spv_t *)0x0;
+    if (magic != _MAGIC) {
+        return spv_fail(spv, "Invalid magic number.");
     }
 
-    do {
-        unsigned short opcode     = _PARSE(data, unsigned short, pos);
-        unsigned short word_count = _PARSE(data, unsigned short, pos);
+    spv->bound = bound;
+
+    while (pos < size) {
+        unsigned int   instruction = _PARSE_WORD(data, pos, swapped);
+        unsigned short opcode      = instruction & 0xFFFF;
+        unsigned short word_count  = instruction >> 16;
+
+        /* The only bounds check: every operand read below stays within word_count.  */
+        if (word_count == 0 || (unsigned long)(word_count - 1) > (size - pos) / sizeof(unsigned int)) {
+            return spv_fail(spv, "Invalid instruction word count.");
+        }
+
+#ifdef SPV_ENABLE_STATS
+        if (spv_stats != (spv_stats_t *)0x0) {
+            _section_e next = spv_stats_section(opcode, section);
+
+            if (next != section) {
+                unsigned long long now = spv_stats_now();
+
+                spv_stats->section_ns[section] += now - section_start;
+                section       = next;
+                section_start = now;
+            }
+
+            if (opcode < SPV_STATS_OPCODES)
+                spv_stats->opcode_counts[opcode]++;
+            else
+                spv_stats->opcode_other++;
+
+            spv_stats->instructions++;
+            spv_stats->words_decoded += word_count;
+        }
+#endif /* SPV_ENABLE_STATS  */
 
         switch (opcode) {
             case 19:
@@ -111,61 +418,70 @@ spv_t *spv_parse(const char *data, unsigned long size) {
             case 29:
             case 31:
             case 32: {
-                _type_t *type = (_type_t *)realloc(spv->types, sizeof(_type_t) * (spv->types_size + 1));
+                _type_t *type = (_type_t *)_REALLOC(spv->types, sizeof(_type_t) * (spv->types_size + 1));
 
                 if (type == (_type_t *)0x0) {
-                    free(spv);
-
-                    spv_current_error = "Failed to allocate memory for type.";
-                    if (spv_error_callback != (void (*)(const char *))0x0)
-                        spv_error_callback(spv_current_error);
-
-                    return (spv_t *)0x0;
+                    return spv_fail(spv, "Failed to allocate memory for type.");
                 }
 
                 spv->types = type;
 
-                memcpy((char *)&spv->types[spv->types_size] + 4, data + pos, (word_count - 1) * sizeof(unsigned int));
+                unsigned long bytes = (word_count - 1) * sizeof(unsigned int);
+
+                /* Trailing operands that do not fit in a _type_t, such as an opaque type's name, are dropped.  */
+                if (bytes > sizeof(_type_t) - 4)
+                    bytes = sizeof(_type_t) - 4;
+
+                memset((char *)&spv->types[spv->types_size] + 4, 0, sizeof(_type_t) - 4);
+                memcpy((char *)&spv->types[spv->types_size] + 4, data + pos, bytes);
+
+                if (swapped) {
+                    unsigned int *words = (unsigned int *)((char *)&spv->types[spv->types_size] + 4);
+
+                    for (unsigned long i = 0; i < bytes / sizeof(unsigned int); ++i)
+                        words[i] = spv_bswap(words[i]);
+                }
 
                 spv->types[spv->types_size].type = opcode;
 
+                if (spv->types[spv->types_size].id >= spv->bound) {
+                    return spv_fail(spv, "Invalid type id.");
+                }
+
                 spv->types_size++;
 
                 pos += (word_count - 1) * sizeof(unsigned int);
             } break;
 
             case 30: {
-                _type_t *type = (_type_t *)realloc(spv->types, sizeof(_type_t) * (spv->types_size + 1));
-
-                if (type == (_type_t *)0x0) {
-                    free(spv);
+                if (word_count < 2) {
+                    return spv_fail(spv, "Invalid struct type.");
+                }
 
-                    spv_current_error = "Failed to allocate memory for type.";
-                    if (spv_error_callback != (void (*)(const char *))0x0)
-                        spv_error_callback(spv_current_error);
+                _type_t *type = (_type_t *)_REALLOC(spv->types, sizeof(_type_t) * (spv->types_size + 1));
 
-                    return (spv_t *)0x0;
+                if (type == (_type_t *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for type.");
                 }
 
                 spv->types = type;
 
-                spv->types[spv->types_size].id                       = _PARSE(data, unsigned int, pos);
-                spv->types[spv->types_size].type                     = opcode;
-                spv->types[spv->types_size].struct_type.member_count = word_count - 2;
-                spv->types[spv->types_size].struct_type.member_types = (unsigned int *)malloc(sizeof(unsigned int) * (word_count - 2));
+                spv->types[spv->types_size].id                       = _PARSE_WORD(data, pos, swapped);
 
-                if (spv->types[spv->types_size].struct_type.member_types == (unsigned int *)0x0) {
-                    free(spv);
+                if (spv->types[spv->types_size].id >= spv->bound) {
+                    return spv_fail(spv, "Invalid type id.");
+                }
 
-                    spv_current_error = "Failed to allocate memory for type.";
-                    if (spv_error_callback != (void (*)(const char *))0x0)
-                        spv_error_callback(spv_current_error);
+                spv->types[spv->types_size].type                     = opcode;
+                spv->types[spv->types_size].struct_type.member_count = word_count - 2;
+                spv->types[spv->types_size].struct_type.member_types = (unsigned int *)_MALLOC(sizeof(unsigned int) * (word_count - 2));
 
-                    return (spv_t *)0x0;
+                if (spv->types[spv->types_size].struct_type.member_types == (unsigned int *)0x0 && word_count > 2) {
+                    return spv_fail(spv, "Failed to allocate memory for type.");
                 }
 
                 for (unsigned short i = 0; i < word_count - 2; i++) {
-                    spv->types[spv->types_size].struct_type.member_types[i] = _PARSE(data, unsigned int, pos);
+                    spv->types[spv->types_size].struct_type.member_types[i] = _PARSE_WORD(data, pos, swapped);
                 }
 
                 spv->types_size++;
@@ -173,160 +489,1138 @@ spv_t *spv_parse(const char *data, unsigned long size) {
             } break;
 
             case 43: {
-                _constant_t *constant = (_constant_t *)realloc(spv->constants, sizeof(_constant_t) * (spv->constants_size + 1));
+                if (word_count < 4) {
+                    return spv_fail(spv, "Invalid constant.");
+                }
+
+                _constant_t *constant = (_constant_t *)_REALLOC(spv->constants, sizeof(_constant_t) * (spv->constants_size + 1));
 
                 if (constant == (_constant_t *)0x0) {
-                    free(spv);
+                    return spv_fail(spv, "Failed to allocate memory for constant.");
+                }
 
-                    spv_current_error = "Failed to allocate memory for constant.";
-                    if (spv_error_callback != (void (*)(const char *))0x0)
-                        spv_error_callback(spv_current_error);
+                spv->constants = constant;
+
+                spv->constants[spv->constants_size].result = _PARSE_WORD(data, pos, swapped);
+                spv->constants[spv->constants_size].type   = _PARSE_WORD(data, pos, swapped);
+                spv->constants[spv->constants_size].value  = _PARSE_WORD(data, pos, swapped);
 
-                    return (spv_t *)0x0;
+                pos += (word_count - 4) * sizeof(unsigned int);
+
+                spv->constants_size++;
+            } break;
+
+            case 71: {
+                if (word_count < 3) {
+                    return spv_fail(spv, "Invalid decoration.");
                 }
 
-                spv->constants = constant;
+                _decoration_t *decoration = (_decoration_t *)_REALLOC(spv->decorations, sizeof(_decoration_t) * (spv->decorations_size + 1));
+
+                if (decoration == (_decoration_t *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for decoration.");
+                }
+
+                spv->decorations = decoration;
+
+                spv->decorations[spv->decorations_size].result     = _PARSE_WORD(data, pos, swapped);
+                spv->decorations[spv->decorations_size].decoration = _PARSE_WORD(data, pos, swapped);
+
+                spv->decorations[spv->decorations_size].value      = 0;
+
+                if (word_count > 3) {
+                    spv->decorations[spv->decorations_size].value      = _PARSE_WORD(data, pos, swapped);
+                    pos += (word_count - 4) * sizeof(unsigned int);
+                }
+
+                spv->decorations_size++;
+            } break;
+
+            case _OP_MEMBER_DECORATE: {
+                if (word_count < 4) {
+                    return spv_fail(spv, "Invalid member decoration.");
+                }
+
+                _member_decoration_t *decoration = (_member_decoration_t *)_REALLOC(spv->member_decorations, sizeof(_member_decoration_t) * (spv->member_decorations_size + 1));
+
+                if (decoration == (_member_decoration_t *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for member decoration.");
+                }
+
+                spv->member_decorations = decoration;
+
+                spv->member_decorations[spv->member_decorations_size].target     = _PARSE_WORD(data, pos, swapped);
+                spv->member_decorations[spv->member_decorations_size].member     = _PARSE_WORD(data, pos, swapped);
+                spv->member_decorations[spv->member_decorations_size].decoration = _PARSE_WORD(data, pos, swapped);
+
+                spv->member_decorations[spv->member_decorations_size].value      = 0;
+
+                if (word_count > 4) {
+                    spv->member_decorations[spv->member_decorations_size].value  = _PARSE_WORD(data, pos, swapped);
+                    pos += (word_count - 5) * sizeof(unsigned int);
+                }
+
+                spv->member_decorations_size++;
+            } break;
+
+            case _OP_NAME: {
+                if (word_count < 2) {
+                    return spv_fail(spv, "Invalid name.");
+                }
+
+                _name_t *name = (_name_t *)_REALLOC(spv->names, sizeof(_name_t) * (spv->names_size + 1));
+
+                if (name == (_name_t *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for name.");
+                }
+
+                spv->names = name;
+
+                spv->names[spv->names_size].target = _PARSE_WORD(data, pos, swapped);
+                spv->names[spv->names_size].name   = spv_parse_string(data, pos, word_count - 2, swapped);
+
+                if (spv->names[spv->names_size].name == (char *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for name.");
+                }
+
+                spv->names_size++;
+
+                pos += (word_count - 2) * sizeof(unsigned int);
+            } break;
+
+            case _OP_MEMBER_NAME: {
+                if (word_count < 3) {
+                    return spv_fail(spv, "Invalid member name.");
+                }
+
+                _member_name_t *name = (_member_name_t *)_REALLOC(spv->member_names, sizeof(_member_name_t) * (spv->member_names_size + 1));
+
+                if (name == (_member_name_t *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for member name.");
+                }
+
+                spv->member_names = name;
+
+                spv->member_names[spv->member_names_size].target = _PARSE_WORD(data, pos, swapped);
+                spv->member_names[spv->member_names_size].member = _PARSE_WORD(data, pos, swapped);
+                spv->member_names[spv->member_names_size].name   = spv_parse_string(data, pos, word_count - 3, swapped);
+
+                if (spv->member_names[spv->member_names_size].name == (char *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for member name.");
+                }
+
+                spv->member_names_size++;
+
+                pos += (word_count - 3) * sizeof(unsigned int);
+            } break;
+
+            case _OP_VARIABLE: {
+                if (word_count < 4) {
+                    return spv_fail(spv, "Invalid variable.");
+                }
+
+                _variable_t *variable = (_variable_t *)_REALLOC(spv->variables, sizeof(_variable_t) * (spv->variables_size + 1));
+
+                if (variable == (_variable_t *)0x0) {
+                    return spv_fail(spv, "Failed to allocate memory for variable.");
+                }
+
+                spv->variables = variable;
+
+                spv->variables[spv->variables_size].result        = _PARSE_WORD(data, pos, swapped);
+                spv->variables[spv->variables_size].id            = _PARSE_WORD(data, pos, swapped);
+                spv->variables[spv->variables_size].storage_class = _PARSE_WORD(data, pos, swapped);
+
+                spv->variables[spv->variables_size].initializer   = 0;
+
+                if (word_count > 4) {
+                    spv->variables[spv->variables_size].initializer   = _PARSE_WORD(data, pos, swapped);
+                    pos += (word_count - 5) * sizeof(unsigned int);
+                }
+
+                spv->variables_size++;
+            } break;
+
+            default: {
+#ifdef SPV_ENABLE_STATS
+                if (spv_stats != (spv_stats_t *)0x0) {
+                    spv_stats->words_decoded -= word_count;
+                    spv_stats->words_skipped += word_count;
+                }
+#endif /* SPV_ENABLE_STATS  */
+
+                pos += (word_count - 1) * sizeof(unsigned int);
+            } break;
+        }
+    }
+
+#ifdef SPV_ENABLE_STATS
+    if (spv_stats != (spv_stats_t *)0x0) {
+        spv_stats->section_ns[section] += spv_stats_now() - section_start;
+
+        /* The arrays of a spv_t only ever grow, so the final size is the peak.  */
+        spv_stats->peak_bytes = spv_memory_usage(spv);
+    }
+#endif /* SPV_ENABLE_STATS  */
+
+    return spv;
+}
+
+/*
+ *    Writes any buffered output to the writer's file descriptor.
+ *
+ *    @param _writer_t *writer    The writer to flush.
+ */
+static void spv_writer_flush(_writer_t *writer) {
+    unsigned long done = 0;
+
+    if (writer->fd < 0)
+        return;
+
+    while (done < writer->buffer->size) {
+        long written = write(writer->fd, writer->buffer->data + done, writer->buffer->size - done);
+
+        if (written < 0 && errno == EINTR)
+            continue;
+
+        if (written <= 0) {
+            writer->failed = 1;
+            break;
+        }
+
+        done += written;
+    }
+
+    writer->buffer->size = 0;
+}
+
+/*
+ *    Appends bytes to a writer, growing its buffer or flushing it as needed.
+ *
+ *    @param _writer_t *writer       The writer to append to.
+ *    @param const char *str         The bytes to append.
+ *    @param unsigned long length    The number of bytes.
+ */
+static void spv_write(_writer_t *writer, const char *str, unsigned long length) {
+    spv_buffer_t *buffer = writer->buffer;
+
+    if (writer->failed)
+        return;
+
+    if (writer->written + length > _EXPORT_MAX_SIZE) {
+        writer->failed    = 1;
+        writer->truncated = 1;
+        return;
+    }
+
+    writer->written += length;
+
+    if (writer->fd < 0 && buffer->size + length > buffer->capacity) {
+        unsigned long capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+
+        while (capacity < buffer->size + length)
+            capacity *= 2;
+
+        char *data = (char *)realloc(buffer->data, capacity);
+
+        if (data == (char *)0x0) {
+            writer->failed = 1;
+            return;
+        }
+
+        buffer->data     = data;
+        buffer->capacity = capacity;
+    }
+
+    while (length > 0 && !writer->failed) {
+        if (buffer->size == buffer->capacity)
+            spv_writer_flush(writer);
+
+        unsigned long chunk = buffer->capacity - buffer->size;
+
+        if (chunk > length)
+            chunk = length;
+
+        memcpy(buffer->data + buffer->size, str, chunk);
+
+        buffer->size += chunk;
+        str          += chunk;
+        length       -= chunk;
+    }
+}
+
+/*
+ *    Appends a null terminated string to a writer.
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param const char *str      The string to append.
+ */
+static void spv_write_str(_writer_t *writer, const char *str) {
+    spv_write(writer, str, strlen(str));
+}
+
+/*
+ *    Appends the decimal representation of an unsigned integer to a writer.
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param unsigned int value   The value to append.
+ */
+static void spv_write_uint(_writer_t *writer, unsigned int value) {
+    char  digits[10];
+    char *end = digits + sizeof(digits);
+    char *str = end;
+
+    do {
+        *--str = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    spv_write(writer, str, end - str);
+}
+
+/*
+ *    Appends a quoted and escaped JSON string to a writer.
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param const char *str      The string to append.
+ */
+static void spv_write_json_str(_writer_t *writer, const char *str) {
+    const char *run = str;
+
+    spv_write(writer, "\"", 1);
+
+    for (; *str != '\0'; ++str) {
+        unsigned char c = (unsigned char)*str;
+
+        if (c != '"' && c != '\\' && c >= 0x20)
+            continue;
+
+        spv_write(writer, run, str - run);
+
+        if (c == '"' || c == '\\') {
+            char escape[2] = { '\\', (char)c };
+            spv_write(writer, escape, 2);
+        } else {
+            char escape[6] = { '\\', 'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0xF] };
+            spv_write(writer, escape, 6);
+        }
+
+        run = str + 1;
+    }
+
+    spv_write(writer, run, str - run);
+    spv_write(writer, "\"", 1);
+}
+
+/*
+ *    Looks up a type by its result id.
+ *
+ *    @param _writer_t *writer    The writer holding the type index.
+ *    @param unsigned int id      The id of the type.
+ *
+ *    @return _type_t *    The type, or null if there is none.
+ */
+static _type_t *spv_export_type(_writer_t *writer, unsigned int id) {
+    if (id >= writer->type_index_size || writer->type_index[id] == 0)
+        return (_type_t *)0x0;
+
+    return &writer->spv->types[writer->type_index[id] - 1];
+}
+
+/*
+ *    Looks up the debug name of an id.
+ *
+ *    @param spv_t *spv         The spv_t struct to use.
+ *    @param unsigned int id    The id to look up.
+ *
+ *    @return const char *    The name, or null if there is none.
+ */
+const char *spv_get_name(spv_t *spv, unsigned int id) {
+    for (unsigned long i = 0; i < spv->names_size; ++i) {
+        if (spv->names[i].target == id && spv->names[i].name[0] != '\0') {
+            return spv->names[i].name;
+        }
+    }
+
+    return (const char *)0x0;
+}
+
+/*
+ *    Looks up the debug name of a struct member.
+ *
+ *    @param spv_t *spv             The spv_t struct to use.
+ *    @param unsigned int id        The id of the struct type.
+ *    @param unsigned int member    The index of the member.
+ *
+ *    @return const char *    The name, or null if there is none.
+ */
+const char *spv_get_member_name(spv_t *spv, unsigned int id, unsigned int member) {
+    for (unsigned long i = 0; i < spv->member_names_size; ++i) {
+        if (spv->member_names[i].target == id && spv->member_names[i].member == member && spv->member_names[i].name[0] != '\0') {
+            return spv->member_names[i].name;
+        }
+    }
+
+    return (const char *)0x0;
+}
+
+/*
+ *    Looks up a decoration of an id.
+ *
+ *    @param spv_t *spv                 The spv_t struct to use.
+ *    @param unsigned int id            The decorated id.
+ *    @param _decoration_e decoration   The decoration to look for.
+ *    @param unsigned int *value        Set to the decoration's value if found.
+ *
+ *    @return int    1 if the decoration was found, 0 otherwise.
+ */
+int spv_get_decoration(spv_t *spv, unsigned int id, _decoration_e decoration, unsigned int *value) {
+    for (unsigned long i = 0; i < spv->decorations_size; ++i) {
+        if (spv->decorations[i].result == id && spv->decorations[i].decoration == decoration) {
+            *value = spv->decorations[i].value;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *    Looks up a decoration of a struct member.
+ *
+ *    @param spv_t *spv                 The spv_t struct to use.
+ *    @param unsigned int id            The id of the struct type.
+ *    @param unsigned int member        The index of the member.
+ *    @param _decoration_e decoration   The decoration to look for.
+ *    @param unsigned int *value        Set to the decoration's value if found.
+ *
+ *    @return int    1 if the decoration was found, 0 otherwise.
+ */
+int spv_get_member_decoration(spv_t *spv, unsigned int id, unsigned int member, _decoration_e decoration, unsigned int *value) {
+    for (unsigned long i = 0; i < spv->member_decorations_size; ++i) {
+        if (spv->member_decorations[i].target == id && spv->member_decorations[i].member == member &&
+            spv->member_decorations[i].decoration == decoration) {
+            *value = spv->member_decorations[i].value;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *    Looks up the value of a constant.
+ *
+ *    @param spv_t *spv           The spv_t struct to use.
+ *    @param unsigned int id      The id of the constant.
+ *
+ *    @return unsigned int    The value of the constant, or 0 if there is none.
+ */
+unsigned int spv_get_constant(spv_t *spv, unsigned int id) {
+    for (unsigned long i = 0; i < spv->constants_size; ++i) {
+        if (spv->constants[i].type == id) {
+            return spv->constants[i].value;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *    Gets the GLSL prefix of a vector or matrix with the given component type.
+ *
+ *    @param _type_t *type    The component type, or null.
+ *
+ *    @return const char *    The prefix, such as "i" for ivec4.
+ */
+static const char *spv_export_prefix(_type_t *type) {
+    if (type == (_type_t *)0x0)
+        return "";
+
+    switch (type->type) {
+        case _TYPE_BOOL: {
+            return "b";
+        } break;
+
+        case _TYPE_INT: {
+            return type->int_type.signedness ? "i" : "u";
+        } break;
+
+        case _TYPE_FLOAT: {
+            return type->float_type.width == 64 ? "d" : "";
+        } break;
+
+        default: {
+            return "";
+        } break;
+    }
+}
+
+/*
+ *    Writes the GLSL suffix of an image type, such as "2DArray".
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param _type_t *type        The image type, or null.
+ */
+static void spv_export_text_dim(_writer_t *writer, _type_t *type) {
+    static const char *dims[] = { "1D", "2D", "3D", "Cube", "2DRect", "Buffer", "SubpassInput" };
+
+    if (type == (_type_t *)0x0 || type->type != _TYPE_IMAGE)
+        return;
+
+    if (type->image_type.dim < sizeof(dims) / sizeof(dims[0]))
+        spv_write_str(writer, dims[type->image_type.dim]);
+
+    if (type->image_type.ms)
+        spv_write_str(writer, "MS");
+
+    if (type->image_type.arrayed)
+        spv_write_str(writer, "Array");
+}
+
+/*
+ *    Writes the name a struct is declared and referred to by.
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param _type_t *type        The struct type.
+ */
+static void spv_export_text_name(_writer_t *writer, _type_t *type) {
+    const char *name = spv_get_name(writer->spv, type->id);
+
+    if (name != (const char *)0x0) {
+        spv_write_str(writer, name);
+    } else {
+        spv_write_str(writer, "struct");
+        spv_write_uint(writer, type->id);
+    }
+}
+
+static void spv_export_text_type(_writer_t *writer, unsigned int id, unsigned int depth);
+
+/*
+ *    Writes the declaration of a struct as GLSL-like text. Member structs
+ *    are referred to by name, as they are declared before it.
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param _type_t *type        The struct type.
+ */
+static void spv_export_text_struct(_writer_t *writer, _type_t *type) {
+    spv_write_str(writer, "struct ");
+    spv_export_text_name(writer, type);
+    spv_write_str(writer, " {\n");
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        const char  *name = spv_get_member_name(writer->spv, type->id, i);
+        unsigned int value;
+
+        spv_write_str(writer, "    ");
+        spv_export_text_type(writer, type->struct_type.member_types[i], 0);
+
+        if (name != (const char *)0x0) {
+            spv_write_str(writer, " ");
+            spv_write_str(writer, name);
+        }
+
+        spv_write_str(writer, ";");
+
+        if (spv_get_member_decoration(writer->spv, type->id, i, _DECORATION_OFFSET, &value)) {
+            spv_write_str(writer, " // offset ");
+            spv_write_uint(writer, value);
+        }
+
+        spv_write_str(writer, "\n");
+    }
+
+    spv_write_str(writer, "};\n\n");
+}
+
+/*
+ *    Writes a type as GLSL-like text.
+ *
+ *    @param _writer_t *writer      The writer to append to.
+ *    @param unsigned int id        The id of the type.
+ *    @param unsigned int depth     The nesting depth.
+ */
+static void spv_export_text_type(_writer_t *writer, unsigned int id, unsigned int depth) {
+    _type_t *type = spv_export_type(writer, id);
+
+    if (type == (_type_t *)0x0 || depth > _EXPORT_MAX_DEPTH) {
+        spv_write_str(writer, "unknown");
+        return;
+    }
+
+    switch (type->type) {
+        case _TYPE_VOID: {
+            spv_write_str(writer, "void");
+        } break;
+
+        case _TYPE_BOOL: {
+            spv_write_str(writer, "bool");
+        } break;
+
+        case _TYPE_INT: {
+            spv_write_str(writer, type->int_type.signedness ? "int" : "uint");
+
+            if (type->int_type.width != 32) {
+                spv_write_uint(writer, type->int_type.width);
+                spv_write_str(writer, "_t");
+            }
+        } break;
+
+        case _TYPE_FLOAT: {
+            if (type->float_type.width == 64)
+                spv_write_str(writer, "double");
+            else if (type->float_type.width == 16)
+                spv_write_str(writer, "float16_t");
+            else
+                spv_write_str(writer, "float");
+        } break;
+
+        case _TYPE_VECTOR: {
+            spv_write_str(writer, spv_export_prefix(spv_export_type(writer, type->vector_type.component_type)));
+            spv_write_str(writer, "vec");
+            spv_write_uint(writer, type->vector_type.component_count);
+        } break;
+
+        case _TYPE_MATRIX: {
+            _type_t     *column = spv_export_type(writer, type->matrix_type.column_type);
+            unsigned int rows   = column != (_type_t *)0x0 ? column->vector_type.component_count : 0;
+
+            if (column != (_type_t *)0x0)
+                spv_write_str(writer, spv_export_prefix(spv_export_type(writer, column->vector_type.component_type)));
+
+            spv_write_str(writer, "mat");
+            spv_write_uint(writer, type->matrix_type.column_count);
+
+            if (rows != type->matrix_type.column_count) {
+                spv_write_str(writer, "x");
+                spv_write_uint(writer, rows);
+            }
+        } break;
+
+        case _TYPE_IMAGE: {
+            spv_write_str(writer, type->image_type.sampled == 2 ? "image" : "texture");
+            spv_export_text_dim(writer, type);
+        } break;
+
+        case _TYPE_SAMPLER: {
+            spv_write_str(writer, "sampler");
+        } break;
+
+        case _TYPE_SAMPLED_IMAGE: {
+            spv_write_str(writer, "sampler");
+            spv_export_text_dim(writer, spv_export_type(writer, type->sampled_image_type.image_type));
+        } break;
+
+        case _TYPE_ARRAY: {
+            spv_export_text_type(writer, type->array_type.element_type, depth + 1);
+            spv_write_str(writer, "[");
+            spv_write_uint(writer, spv_get_constant(writer->spv, type->array_type.length));
+            spv_write_str(writer, "]");
+        } break;
+
+        case _TYPE_RUNTIME_ARRAY: {
+            spv_export_text_type(writer, type->runtime_array_type.element_type, depth + 1);
+            spv_write_str(writer, "[]");
+        } break;
+
+        case _TYPE_STRUCT: {
+            spv_export_text_name(writer, type);
+        } break;
+
+        case _TYPE_POINTER: {
+            spv_export_text_type(writer, type->pointer_type.type, depth + 1);
+            spv_write_str(writer, "*");
+        } break;
+
+        default: {
+            spv_write_str(writer, "unknown");
+        } break;
+    }
+}
+
+static void spv_export_json_type(_writer_t *writer, unsigned int id, unsigned int depth);
+
+/*
+ *    Writes the definition of a struct as an entry of the JSON types table.
+ *    Member structs are referred to by id, as they have entries of their own.
+ *
+ *    @param _writer_t *writer    The writer to append to.
+ *    @param _type_t *type        The struct type.
+ */
+static void spv_export_json_struct(_writer_t *writer, _type_t *type) {
+    const char  *name = spv_get_name(writer->spv, type->id);
+    unsigned int value;
+
+    spv_write_str(writer, "\"");
+    spv_write_uint(writer, type->id);
+    spv_write_str(writer, "\":{\"kind\":\"struct\"");
+
+    if (name != (const char *)0x0) {
+        spv_write_str(writer, ",\"name\":");
+        spv_write_json_str(writer, name);
+    }
+
+    if (spv_get_decoration(writer->spv, type->id, _DECORATION_BLOCK, &value))
+        spv_write_str(writer, ",\"block\":true");
+
+    if (spv_get_decoration(writer->spv, type->id, _DECORATION_BUFFER_BLOCK, &value))
+        spv_write_str(writer, ",\"buffer_block\":true");
+
+    spv_write_str(writer, ",\"members\":[");
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        spv_write_str(writer, i == 0 ? "{" : ",{");
+
+        name = spv_get_member_name(writer->spv, type->id, i);
+
+        if (name != (const char *)0x0) {
+            spv_write_str(writer, "\"name\":");
+            spv_write_json_str(writer, name);
+            spv_write_str(writer, ",");
+        }
+
+        if (spv_get_member_decoration(writer->spv, type->id, i, _DECORATION_OFFSET, &value)) {
+            spv_write_str(writer, "\"offset\":");
+            spv_write_uint(writer, value);
+            spv_write_str(writer, ",");
+        }
+
+        if (spv_get_member_decoration(writer->spv, type->id, i, _DECORATION_MATRIX_STRIDE, &value)) {
+            spv_write_str(writer, "\"matrix_stride\":");
+            spv_write_uint(writer, value);
+            spv_write_str(writer, ",");
+        }
+
+        if (spv_get_member_decoration(writer->spv, type->id, i, _DECORATION_BUILTIN, &value)) {
+            spv_write_str(writer, "\"builtin\":");
+            spv_write_uint(writer, value);
+            spv_write_str(writer, ",");
+        }
+
+        spv_write_str(writer, "\"type\":");
+        spv_export_json_type(writer, type->struct_type.member_types[i], 0);
+        spv_write_str(writer, "}");
+    }
+
+    spv_write_str(writer, "]}");
+}
+
+/*
+ *    Writes a type as a JSON object.
+ *
+ *    @param _writer_t *writer      The writer to append to.
+ *    @param unsigned int id        The id of the type.
+ *    @param unsigned int depth     The nesting depth.
+ */
+static void spv_export_json_type(_writer_t *writer, unsigned int id, unsigned int depth) {
+    _type_t     *type = spv_export_type(writer, id);
+    unsigned int value;
+
+    if (type == (_type_t *)0x0 || depth > _EXPORT_MAX_DEPTH) {
+        spv_write_str(writer, "{\"kind\":\"unknown\"}");
+        return;
+    }
+
+    switch (type->type) {
+        case _TYPE_VOID: {
+            spv_write_str(writer, "{\"kind\":\"void\"}");
+        } break;
+
+        case _TYPE_BOOL: {
+            spv_write_str(writer, "{\"kind\":\"bool\"}");
+        } break;
+
+        case _TYPE_INT: {
+            spv_write_str(writer, "{\"kind\":\"int\",\"width\":");
+            spv_write_uint(writer, type->int_type.width);
+            spv_write_str(writer, type->int_type.signedness ? ",\"signed\":true}" : ",\"signed\":false}");
+        } break;
+
+        case _TYPE_FLOAT: {
+            spv_write_str(writer, "{\"kind\":\"float\",\"width\":");
+            spv_write_uint(writer, type->float_type.width);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_VECTOR: {
+            spv_write_str(writer, "{\"kind\":\"vector\",\"count\":");
+            spv_write_uint(writer, type->vector_type.component_count);
+            spv_write_str(writer, ",\"component\":");
+            spv_export_json_type(writer, type->vector_type.component_type, depth + 1);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_MATRIX: {
+            spv_write_str(writer, "{\"kind\":\"matrix\",\"columns\":");
+            spv_write_uint(writer, type->matrix_type.column_count);
+            spv_write_str(writer, ",\"column\":");
+            spv_export_json_type(writer, type->matrix_type.column_type, depth + 1);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_IMAGE: {
+            spv_write_str(writer, "{\"kind\":\"image\",\"dim\":");
+            spv_write_uint(writer, type->image_type.dim);
+            spv_write_str(writer, ",\"depth\":");
+            spv_write_uint(writer, type->image_type.depth);
+            spv_write_str(writer, ",\"arrayed\":");
+            spv_write_uint(writer, type->image_type.arrayed);
+            spv_write_str(writer, ",\"ms\":");
+            spv_write_uint(writer, type->image_type.ms);
+            spv_write_str(writer, ",\"sampled\":");
+            spv_write_uint(writer, type->image_type.sampled);
+            spv_write_str(writer, ",\"format\":");
+            spv_write_uint(writer, type->image_type.image_format);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_SAMPLER: {
+            spv_write_str(writer, "{\"kind\":\"sampler\"}");
+        } break;
+
+        case _TYPE_SAMPLED_IMAGE: {
+            spv_write_str(writer, "{\"kind\":\"sampled_image\",\"image\":");
+            spv_export_json_type(writer, type->sampled_image_type.image_type, depth + 1);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_ARRAY: {
+            spv_write_str(writer, "{\"kind\":\"array\",\"length\":");
+            spv_write_uint(writer, spv_get_constant(writer->spv, type->array_type.length));
+
+            if (spv_get_decoration(writer->spv, type->id, _DECORATION_ARRAY_STRIDE, &value)) {
+                spv_write_str(writer, ",\"stride\":");
+                spv_write_uint(writer, value);
+            }
+
+            spv_write_str(writer, ",\"element\":");
+            spv_export_json_type(writer, type->array_type.element_type, depth + 1);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_RUNTIME_ARRAY: {
+            spv_write_str(writer, "{\"kind\":\"runtime_array\"");
+
+            if (spv_get_decoration(writer->spv, type->id, _DECORATION_ARRAY_STRIDE, &value)) {
+                spv_write_str(writer, ",\"stride\":");
+                spv_write_uint(writer, value);
+            }
+
+            spv_write_str(writer, ",\"element\":");
+            spv_export_json_type(writer, type->runtime_array_type.element_type, depth + 1);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_STRUCT: {
+            spv_write_str(writer, "{\"kind\":\"struct\",\"id\":");
+            spv_write_uint(writer, type->id);
+            spv_write_str(writer, "}");
+        } break;
+
+        case _TYPE_POINTER: {
+            spv_write_str(writer, "{\"kind\":\"pointer\",\"storage_class\":");
+            spv_write_uint(writer, type->pointer_type.storage_class);
+            spv_write_str(writer, ",\"type\":");
+            spv_export_json_type(writer, type->pointer_type.type, depth + 1);
+            spv_write_str(writer, "}");
+        } break;
+
+        default: {
+            spv_write_str(writer, "{\"kind\":\"unknown\"}");
+        } break;
+    }
+}
+
+/*
+ *    Gets the keyword used for a variable's storage class.
+ *
+ *    @param spv_t *spv               The spv_t struct to use.
+ *    @param _variable_t *variable    The variable.
+ *    @param _type_t *type            The variable's pointee type, or null.
+ *
+ *    @return const char *    The keyword, or null if the variable is not part of the interface.
+ */
+static const char *spv_export_storage(spv_t *spv, _variable_t *variable, _type_t *type) {
+    unsigned int value;
+
+    switch (variable->storage_class) {
+        case 0x0: {
+            return "uniformconstant";
+        } break;
+
+        case 0x1: {
+            return "in";
+        } break;
+
+        case 0x2: {
+            if (type != (_type_t *)0x0 && spv_get_decoration(spv, type->id, _DECORATION_BUFFER_BLOCK, &value))
+                return "buffer";
+
+            return "uniform";
+        } break;
+
+        case 0x3: {
+            return "out";
+        } break;
+
+        case 0x4: {
+            return "shared";
+        } break;
+
+        case 0x9: {
+            return "pushconstant";
+        } break;
+
+        case 0xC: {
+            return "buffer";
+        } break;
+
+        default: {
+            return (const char *)0x0;
+        } break;
+    }
+}
+
+/*
+ *    Gets the type a variable points to.
+ *
+ *    @param _writer_t *writer        The writer holding the type index.
+ *    @param _variable_t *variable    The variable.
+ *
+ *    @return _type_t *    The pointee type, or null if it is unknown.
+ */
+static _type_t *spv_export_variable_type(_writer_t *writer, _variable_t *variable) {
+    _type_t *type = spv_export_type(writer, variable->result);
+
+    if (type != (_type_t *)0x0 && type->type == _TYPE_POINTER)
+        type = spv_export_type(writer, type->pointer_type.type);
+
+    return type;
+}
+
+/*
+ *    Collects the structs reachable from a type, members before the structs
+ *    containing them, so each is written once however often it is used.
+ *
+ *    @param _writer_t *writer      The writer to collect into.
+ *    @param unsigned int id        The id of the type.
+ *    @param unsigned int depth     The nesting depth.
+ */
+static void spv_export_collect(_writer_t *writer, unsigned int id, unsigned int depth) {
+    _type_t *type = spv_export_type(writer, id);
+
+    if (type == (_type_t *)0x0 || depth > _EXPORT_MAX_DEPTH)
+        return;
+
+    switch (type->type) {
+        case _TYPE_ARRAY: {
+            spv_export_collect(writer, type->array_type.element_type, depth + 1);
+        } break;
+
+        case _TYPE_RUNTIME_ARRAY: {
+            spv_export_collect(writer, type->runtime_array_type.element_type, depth + 1);
+        } break;
+
+        case _TYPE_POINTER: {
+            spv_export_collect(writer, type->pointer_type.type, depth + 1);
+        } break;
+
+        case _TYPE_STRUCT: {
+            /* Marked before its members, so self-referencing structs stop here.  */
+            if (writer->struct_state[id])
+                return;
+
+            writer->struct_state[id] = 1;
+
+            for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+                spv_export_collect(writer, type->struct_type.member_types[i], depth + 1);
+            }
+
+            writer->structs[writer->structs_size++] = id;
+        } break;
+
+        default: {
+        } break;
+    }
+}
+
+/*
+ *    Writes the interface variables of a module.
+ *
+ *    @param _writer_t *writer          The writer to append to.
+ *    @param _export_format_e format    The output format.
+ */
+static void spv_export_variables(_writer_t *writer, _export_format_e format) {
+    static const _decoration_e  layouts[]   = { _DECORATION_LOCATION, _DECORATION_DESCRIPTOR_SET, _DECORATION_BINDING, _DECORATION_BUILTIN };
+    static const char          *text_keys[] = { "location = ", "set = ", "binding = ", "builtin = " };
+    static const char          *json_keys[] = { ",\"location\":", ",\"set\":", ",\"binding\":", ",\"builtin\":" };
+
+    spv_t *spv   = writer->spv;
+    int    first = 1;
 
-                spv->constants[spv->constants_size].result = _PARSE(data, unsigned int, pos);
-                spv->constants[spv->constants_size].type   = _PARSE(data, unsigned int, pos);
-                spv->constants[spv->constants_size].value  = _PARSE(data, unsigned int, pos);
+    for (unsigned long i = 0; i < spv->variables_size; ++i) {
+        _type_t *type = spv_export_variable_type(writer, &spv->variables[i]);
 
-                pos += (word_count - 4) * sizeof(unsigned int);
+        if (type != (_type_t *)0x0 && spv_export_storage(spv, &spv->variables[i], type) != (const char *)0x0)
+            spv_export_collect(writer, type->id, 0);
+    }
 
-                spv->constants_size++;
-            } break;
+    /* Structs are defined once up front and referred to by name or id from then on.  */
+    if (format == _EXPORT_JSON)
+        spv_write_str(writer, "{\"types\":{");
 
-            case 71: {
-                _decoration_t *decoration = (_decoration_t *)realloc(spv->decorations, sizeof(_decoration_t) * (spv->decorations_size + 1));
+    for (unsigned long i = 0; i < writer->structs_size; ++i) {
+        _type_t *type = spv_export_type(writer, writer->structs[i]);
 
-                if (decoration == (_decoration_t *)0x0) {
-                    free(spv);
+        if (format == _EXPORT_JSON) {
+            if (i > 0)
+                spv_write_str(writer, ",");
 
-                    spv_current_error = "Failed to allocate memory for decoration.";
-                    if (spv_error_callback != (void (*)(const char *))0x0)
-                        spv_error_callback(spv_current_error);
+            spv_export_json_struct(writer, type);
+        } else {
+            spv_export_text_struct(writer, type);
+        }
+    }
 
-                    return (spv_t *)0x0;
-                }
+    if (format == _EXPORT_JSON)
+        spv_write_str(writer, "},\"variables\":[");
 
-                spv->decorations = decoration;
+    for (unsigned long i = 0; i < spv->variables_size; ++i) {
+        _variable_t *variable = &spv->variables[i];
+        _type_t     *type     = spv_export_variable_type(writer, variable);
 
-                spv->decorations[spv->decorations_size].result     = _PARSE(data, unsigned int, pos);
-                spv->decorations[spv->decorations_size].decoration = _PARSE(data, unsigned int, pos);
+        const char *storage = spv_export_storage(spv, variable, type);
+        const char *name    = spv_get_name(spv, variable->id);
 
-                if (word_count > 3) {
-                    spv->decorations[spv->decorations_size].value      = _PARSE(data, unsigned int, pos);
-                }
+        if (storage == (const char *)0x0)
+            continue;
 
-                spv->decorations_size++;
-            } break;
+        if (format == _EXPORT_JSON) {
+            spv_write_str(writer, first ? "{\"id\":" : ",{\"id\":");
+            spv_write_uint(writer, variable->id);
 
-            case _OP_VARIABLE: {
-                _variable_t *variable = (_variable_t *)realloc(spv->variables, sizeof(_variable_t) * (spv->variables_size + 1));
+            if (name != (const char *)0x0) {
+                spv_write_str(writer, ",\"name\":");
+                spv_write_json_str(writer, name);
+            }
 
-                if (variable == (_variable_t *)0x0) {
-                    free(spv);
+            spv_write_str(writer, ",\"storage\":\"");
+            spv_write_str(writer, storage);
+            spv_write_str(writer, "\"");
 
-                    spv_current_error = "Failed to allocate memory for variable.";
-                    if (spv_error_callback != (void (*)(const char *))0x0)
-                        spv_error_callback(spv_current_error);
+            for (unsigned int j = 0; j < sizeof(layouts) / sizeof(layouts[0]); ++j) {
+                unsigned int value;
 
-                    return (spv_t *)0x0;
+                if (spv_get_decoration(spv, variable->id, layouts[j], &value)) {
+                    spv_write_str(writer, json_keys[j]);
+                    spv_write_uint(writer, value);
                 }
+            }
 
-                spv->variables = variable;
+            spv_write_str(writer, ",\"type\":");
+            spv_export_json_type(writer, type != (_type_t *)0x0 ? type->id : 0, 0);
+            spv_write_str(writer, "}");
+        } else {
+            int layout = 0;
 
-                spv->variables[spv->variables_size].result        = _PARSE(data, unsigned int, pos);
-                spv->variables[spv->variables_size].id            = _PARSE(data, unsigned int, pos);
-                spv->variables[spv->variables_size].storage_class = _PARSE(data, unsigned int, pos);
+            for (unsigned int j = 0; j < sizeof(layouts) / sizeof(layouts[0]); ++j) {
+                unsigned int value;
 
-                if (word_count > 4) {
-                    spv->variables[spv->variables_size].initializer   = _PARSE(data, unsigned int, pos);
+                if (spv_get_decoration(spv, variable->id, layouts[j], &value)) {
+                    spv_write_str(writer, layout ? ", " : "layout(");
+                    spv_write_str(writer, text_keys[j]);
+                    spv_write_uint(writer, value);
+                    layout = 1;
                 }
+            }
 
-                spv->variables_size++;
-            } break;
+            if (layout)
+                spv_write_str(writer, ") ");
 
-            default: {
-                for (unsigned short i = 0; i < word_count - 1; i++) {
-                    _PARSE(data, unsigned int, pos);
-                }
-            } break;
-        }
-    } while(pos < size);
+            spv_write_str(writer, storage);
+            spv_write_str(writer, " ");
+            spv_export_text_type(writer, type != (_type_t *)0x0 ? type->id : 0, 0);
 
-    return spv;
-}
+            if (name != (const char *)0x0) {
+                spv_write_str(writer, " ");
+                spv_write_str(writer, name);
+            }
 
-/*
- *    Prints the value of a constant.
- *
- *    @param spv_t *spv         The spv_t struct to use.
- *    @param unsigned int id    The id of the constant.
- */
-void spv_print_constant(spv_t *spv, unsigned int id) {
-    for (unsigned long j = 0; j < spv->constants_size; ++j) {
-        if (spv->constants[j].type == id) {
-            printf("%u", spv->constants[j].value);
+            spv_write_str(writer, ";\n");
         }
+
+        first = 0;
     }
+
+    if (format == _EXPORT_JSON)
+        spv_write_str(writer, "]}\n");
 }
 
 /*
- *    Prints the type of a variable.
+ *    Exports a module through a writer.
  *
- *    @param spv_t *spv         The spv_t struct to use.
- *    @param unsigned int id    The id of the variable.
+ *    @param _writer_t *writer          The writer to append to.
+ *    @param _export_format_e format    The output format.
+ *
+ *    @return int    0 on success, -1 on failure.
  */
-void spv_print_type(spv_t *spv, unsigned int id) {
-    for (unsigned long j = 0; j < spv->types_size; ++j) {
-        if (spv->types[j].id == id) {
-            switch (spv->types[j].type) {
-                case _TYPE_FLOAT: {
-                    printf("float");
-                } break;
+static int spv_export_writer(_writer_t *writer, _export_format_e format) {
+    spv_t *spv = writer->spv;
 
-                case _TYPE_VECTOR: {
-                    printf("vec%u", spv->types[j].vector_type.component_count);
-                } break;
+    /* Index the types by id once, so nested type lookups are constant time. The header
+       bound need not be tight, so the index is sized from the largest type id instead.  */
+    writer->type_index_size = 0;
 
-                case _TYPE_IMAGE: {
-                    printf("image");
-                } break;
+    for (unsigned long i = 0; i < spv->types_size; ++i) {
+        if (spv->types[i].id >= writer->type_index_size)
+            writer->type_index_size = (unsigned long)spv->types[i].id + 1;
+    }
 
-                case _TYPE_SAMPLED_IMAGE: {
-                    printf("sampler");
-                } break;
+    if (writer->type_index_size > _MAX_ID_BOUND) {
+        spv_current_error = "Invalid type id.";
+        if (spv_error_callback != (void (*)(const char *))0x0)
+            spv_error_callback(spv_current_error);
 
-                case _TYPE_POINTER: {
-                    spv_print_type(spv, spv->types[j].pointer_type.type);
-                    printf("*");
-                } break;
+        return -1;
+    }
 
-                case _TYPE_ARRAY: {
-                    spv_print_type(spv, spv->types[j].array_type.element_type);
-                    printf("[");
-                    spv_print_constant(spv, spv->types[j].array_type.length);
-                    printf("]");
-                } break;
+    writer->type_index   = (unsigned int *)calloc(writer->type_index_size + 1, sizeof(unsigned int));
+    writer->struct_state = (unsigned char *)calloc(writer->type_index_size + 1, sizeof(unsigned char));
+    writer->structs      = (unsigned int *)malloc(sizeof(unsigned int) * (spv->types_size + 1));
 
-                case _TYPE_STRUCT: {
-                    printf("struct { ");
+    if (writer->type_index == (unsigned int *)0x0 || writer->struct_state == (unsigned char *)0x0 || writer->structs == (unsigned int *)0x0) {
+        free(writer->type_index);
+        free(writer->struct_state);
+        free(writer->structs);
 
-                    for (unsigned short i = 0; i < spv->types[j].struct_type.member_count; ++i) {
-                        spv_print_type(spv, spv->types[j].struct_type.member_types[i]);
-                        printf(" ");
-                    }
+        spv_current_error = "Failed to allocate memory for export.";
+        if (spv_error_callback != (void (*)(const char *))0x0)
+            spv_error_callback(spv_current_error);
 
-                    printf("}");
-                } break;
+        return -1;
+    }
 
-                default: {
-                    printf("unknown");
-                } break;
-            }
-        }
+    for (unsigned long i = 0; i < spv->types_size; ++i) {
+        writer->type_index[spv->types[i].id] = i + 1;
+    }
+
+    spv_export_variables(writer, format);
+    spv_writer_flush(writer);
+
+    free(writer->type_index);
+    free(writer->struct_state);
+    free(writer->structs);
+
+    if (writer->failed) {
+        spv_current_error = writer->truncated ? "Export exceeds the size limit." : "Failed to write export.";
+        if (spv_error_callback != (void (*)(const char *))0x0)
+            spv_error_callback(spv_current_error);
+
+        return -1;
     }
+
+    return 0;
 }
 
 /*
@@ -366,7 +1660,7 @@ _api_type_e spv_get_input_type(spv_t *spv, unsigned int id) {
                 continue;
             }
 
-            _type_t type;
+            _type_t type = { 0 };
 
             for (unsigned long j = 0; j < spv->types_size; ++j) {
                 if (spv->types[j].id == spv->variables[i].result) {
@@ -448,7 +1742,7 @@ _api_type_e spv_get_uniform_type(spv_t *spv, unsigned int id) {
                 continue;
             }
 
-            _type_t type;
+            _type_t type = { 0 };
 
             for (unsigned long j = 0; j < spv->types_size; ++j) {
                 if (spv->types[j].id == spv->variables[i].result) {
@@ -487,35 +1781,531 @@ _api_type_e spv_get_uniform_type(spv_t *spv, unsigned int id) {
     return _API_TYPE_NONE;
 }
 
+/*
+ *    Exports the interface of a spv_t struct as GLSL-like text or JSON,
+ *    appending the output to a growable buffer.
+ *
+ *    @param spv_t *spv                 The spv_t struct to export.
+ *    @param _export_format_e format    The output format.
+ *    @param spv_buffer_t *buffer       The buffer to append to.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+int spv_export(spv_t *spv, _export_format_e format, spv_buffer_t *buffer) {
+    _writer_t writer = { 0 };
+
+    writer.spv    = spv;
+    writer.buffer = buffer;
+    writer.fd     = -1;
+
+    return spv_export_writer(&writer, format);
+}
+
+/*
+ *    Exports the interface of a spv_t struct as GLSL-like text or JSON
+ *    to a file descriptor, through a single buffered writer.
+ *
+ *    @param spv_t *spv                 The spv_t struct to export.
+ *    @param _export_format_e format    The output format.
+ *    @param int fd                     The file descriptor to write to.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+int spv_export_fd(spv_t *spv, _export_format_e format, int fd) {
+    char         data[_EXPORT_CHUNK];
+    spv_buffer_t buffer = { data, 0, sizeof(data) };
+    _writer_t    writer = { 0 };
+
+    writer.spv    = spv;
+    writer.buffer = &buffer;
+    writer.fd     = fd;
+
+    return spv_export_writer(&writer, format);
+}
+
 /*
  *    Dumps the information about the inputs, outputs, and uniforms in a spv_t struct.
  *
  *    @param spv_t *spv    The spv_t struct to dump.
  */
 void spv_dump(spv_t *spv) {
-    for (unsigned long i = 0; i < spv->variables_size; ++i) {
-        if (spv->variables[i].storage_class == 0x0) {
-            printf("uniformconstant ");
-            spv_print_type(spv, spv->variables[i].result);
-            printf(";\n");
-        } else if (spv->variables[i].storage_class == 0x1) {
-            printf("in ");
-            spv_print_type(spv, spv->variables[i].result);
-            printf(";\n");
-        } else if (spv->variables[i].storage_class == 0x2) {
-            printf("uniform ");
-            spv_print_type(spv, spv->variables[i].result);
-            printf(";\n");
-        } else if (spv->variables[i].storage_class == 0x3) {
-            printf("out ");
-            spv_print_type(spv, spv->variables[i].result);
-            printf(";\n");
-        } else if (spv->variables[i].storage_class == 0x9) {
-            printf("pushconstant ");
-            spv_print_type(spv, spv->variables[i].result);
-            printf(";\n");
+    /* Output goes straight to the descriptor, so anything already printed must come first.  */
+    fflush(stdout);
+
+    spv_export_fd(spv, _EXPORT_TEXT, 1);
+}
+
+/*
+ *    Gets the cost category of a function body instruction.
+ *
+ *    @param const char *data       The spirv binary data.
+ *    @param unsigned long pos      The position of the instruction's first operand.
+ *    @param unsigned short opcode  The opcode of the instruction.
+ *    @param unsigned short words   The word count of the instruction.
+ *    @param unsigned int glsl      The id of the GLSL.std.450 import, or 0.
+ *    @param int swapped            Whether the module is byte-swapped.
+ *
+ *    @return _cost_e    The category of the instruction.
+ */
+static _cost_e spv_cost_category(const char *data, unsigned long pos, unsigned short opcode, unsigned short words, unsigned int glsl, int swapped) {
+    switch (opcode) {
+        case _OP_EXT_INST: {
+            if (words < 5 || glsl == 0)
+                return _COST_ALU;
+
+            unsigned int set         = _OPERAND(data, pos, 2, swapped);
+            unsigned int instruction = _OPERAND(data, pos, 3, swapped);
+
+            /* Sin through InverseSqrt in GLSL.std.450.  */
+            if (set == glsl && instruction >= 13 && instruction <= 32)
+                return _COST_TRANSCENDENTAL;
+
+            return _COST_ALU;
+        } break;
+
+        case _OP_LOAD:
+        case _OP_ATOMIC_LOAD: {
+            return _COST_LOAD;
+        } break;
+
+        case _OP_STORE:
+        case _OP_COPY_MEMORY:
+        case _OP_COPY_MEMORY_SIZED:
+        case _OP_IMAGE_WRITE: {
+            return _COST_STORE;
+        } break;
+
+        case _OP_CONTROL_BARRIER:
+        case _OP_MEMORY_BARRIER: {
+            return _COST_BARRIER;
+        } break;
+
+        case _OP_BRANCH:
+        case _OP_BRANCH_CONDITIONAL:
+        case _OP_SWITCH: {
+            return _COST_BRANCH;
+        } break;
+
+        default: {
+            if (opcode >= _OP_IMAGE_SAMPLE_FIRST && opcode <= _OP_IMAGE_READ)
+                return _COST_SAMPLE;
+
+            if (opcode >= _OP_IMAGE_SPARSE_FIRST && opcode <= _OP_IMAGE_SPARSE_LAST)
+                return _COST_SAMPLE;
+
+            /* Atomic read-modify-write operations count as stores.  */
+            if (opcode >= _OP_ATOMIC_STORE && opcode <= _OP_ATOMIC_LAST)
+                return _COST_STORE;
+
+            /* Composites, conversions, arithmetic, bit, relational and derivative ops.  */
+            if ((opcode >= _OP_VECTOR_SHUFFLE && opcode <= _OP_TRANSPOSE) || (opcode >= _OP_ALU_FIRST && opcode <= _OP_ALU_LAST))
+                return _COST_ALU;
+
+            return _COST_OTHER;
+        } break;
+    }
+}
+
+/*
+ *    Gets the operand index of an instruction's result id.
+ *
+ *    @param unsigned short opcode    The opcode of the instruction.
+ *
+ *    @return unsigned int    The operand index of the result id, or 0 if it has none.
+ */
+static unsigned int spv_cost_result(unsigned short opcode) {
+    switch (opcode) {
+        case _OP_NOP:
+        case _OP_LINE:
+        case _OP_FUNCTION_END:
+        case _OP_STORE:
+        case _OP_COPY_MEMORY:
+        case _OP_COPY_MEMORY_SIZED:
+        case _OP_IMAGE_WRITE:
+        case _OP_CONTROL_BARRIER:
+        case _OP_MEMORY_BARRIER:
+        case _OP_ATOMIC_STORE:
+        case _OP_LOOP_MERGE:
+        case _OP_SELECTION_MERGE:
+        case _OP_BRANCH:
+        case _OP_BRANCH_CONDITIONAL:
+        case _OP_SWITCH:
+        case _OP_KILL:
+        case _OP_RETURN:
+        case _OP_RETURN_VALUE:
+        case _OP_UNREACHABLE:
+        case _OP_NO_LINE: {
+            return 0;
+        } break;
+
+        case _OP_LABEL: {
+            return 1;
+        } break;
+
+        default: {
+            return 2;
+        } break;
+    }
+}
+
+/*
+ *    Grows the per-id tables of a cost estimate to hold an id.
+ *
+ *    @param _cost_state_t *state    The state to grow.
+ *    @param unsigned int id         The id that must fit.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spv_cost_reserve(_cost_state_t *state, unsigned int id) {
+    unsigned long size = state->ids_size ? state->ids_size : 256;
+
+    while (size <= id)
+        size *= 2;
+
+    unsigned long *def = (unsigned long *)realloc(state->def, sizeof(unsigned long) * size);
+
+    if (def == (unsigned long *)0x0)
+        return -1;
+
+    state->def = def;
+
+    unsigned long *last = (unsigned long *)realloc(state->last, sizeof(unsigned long) * size);
+
+    if (last == (unsigned long *)0x0)
+        return -1;
+
+    state->last = last;
+
+    memset(state->def + state->ids_size, 0, sizeof(unsigned long) * (size - state->ids_size));
+    memset(state->last + state->ids_size, 0, sizeof(unsigned long) * (size - state->ids_size));
+
+    state->ids_size = size;
+
+    return 0;
+}
+
+/*
+ *    Finishes the cost estimate of a function by computing its peak number
+ *    of simultaneously live ids from the definition and last use of each id.
+ *
+ *    @param _cost_state_t *state         The analysis state.
+ *    @param _function_cost_t *function   The function to finish.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spv_cost_pressure(_cost_state_t *state, _function_cost_t *function) {
+    unsigned long length = state->position - state->start + 2;
+    long         *delta  = (long *)calloc(length, sizeof(long));
+    long          live   = 0;
+
+    if (delta == (long *)0x0)
+        return -1;
+
+    for (unsigned long i = 0; i < state->defs_size; ++i) {
+        unsigned int id = state->defs[i];
+
+        delta[state->def[id] - state->start]++;
+        delta[state->last[id] - state->start + 1]--;
+    }
+
+    for (unsigned long i = 0; i < length; ++i) {
+        live += delta[i];
+
+        if (live > (long)function->pressure)
+            function->pressure = live;
+    }
+
+    free(delta);
+
+    return 0;
+}
+
+/*
+ *    Frees the state used by spv_estimate_cost, along with a partial result.
+ *
+ *    @param _cost_state_t *state    The analysis state.
+ *    @param spv_cost_t *cost        The partial result, or null.
+ *    @param const char *error       The error message.
+ *
+ *    @return spv_cost_t *    Always null.
+ */
+static spv_cost_t *spv_cost_fail(_cost_state_t *state, spv_cost_t *cost, const char *error) {
+    free(state->def);
+    free(state->last);
+    free(state->defs);
+
+    if (cost != (spv_cost_t *)0x0)
+        spv_free_cost(cost);
+
+    spv_current_error = error;
+    if (spv_error_callback != (void (*)(const char *))0x0)
+        spv_error_callback(spv_current_error);
+
+    return (spv_cost_t *)0x0;
+}
+
+/*
+ *    Estimates the cost of every function in a spirv module.
+ *
+ *    @param const char *data    The spirv binary data to analyze.
+ *    @param unsigned long size  The size of the spirv binary data.
+ *
+ *    @return spv_cost_t *       A pointer to the estimates, or null on failure.
+ */
+spv_cost_t *spv_estimate_cost(const char *data, unsigned long size) {
+    _cost_state_t     state    = { 0 };
+    _function_cost_t *function = (_function_cost_t *)0x0;
+    unsigned int      merges[_COST_MAX_LOOPS];
+    unsigned int      loops    = 0;
+    unsigned int      glsl     = 0;
+
+    if (size < 5 * sizeof(unsigned int) || size % sizeof(unsigned int) != 0) {
+        return spv_cost_fail(&state, (spv_cost_t *)0x0, "Invalid module size.");
+    }
+
+    int swapped = *(const unsigned int *)data == _MAGIC_SWAPPED;
+
+    if (spv_word(data, 0, swapped) != _MAGIC) {
+        return spv_cost_fail(&state, (spv_cost_t *)0x0, "Invalid magic number.");
+    }
+
+    unsigned int bound = spv_word(data, 3 * sizeof(unsigned int), swapped);
+
+    /* The bound need not be tight, the id tables grow to the largest id defined instead.  */
+    if (bound > _MAX_ID_BOUND) {
+        return spv_cost_fail(&state, (spv_cost_t *)0x0, "Invalid id bound.");
+    }
+
+    spv_cost_t *cost = (spv_cost_t *)malloc(sizeof(spv_cost_t));
+
+    if (cost == (spv_cost_t *)0x0) {
+        return spv_cost_fail(&state, (spv_cost_t *)0x0, "Failed to allocate memory for cost estimate.");
+    }
+
+    cost->functions      = (_function_cost_t *)0x0;
+    cost->functions_size = 0;
+
+    unsigned long pos = 5 * sizeof(unsigned int);
+
+    while (pos < size) {
+        unsigned int   instruction = _PARSE_WORD(data, pos, swapped);
+        unsigned short opcode      = instruction & 0xFFFF;
+        unsigned short word_count  = instruction >> 16;
+
+        if (word_count == 0 || (unsigned long)(word_count - 1) > (size - pos) / sizeof(unsigned int)) {
+            return spv_cost_fail(&state, cost, "Invalid instruction word count.");
+        }
+
+        /* "GLSL.std.450" and its terminator fill exactly four words.  */
+        if (opcode == _OP_EXT_INST_IMPORT && word_count == 6) {
+            const char    *name = "GLSL.std.450";
+            unsigned long  flip = swapped ? 3 : 0;
+            unsigned long  i    = 0;
+
+            while (i <= 12 && data[pos + sizeof(unsigned int) + (i ^ flip)] == name[i])
+                i++;
+
+            if (i > 12)
+                glsl = _OPERAND(data, pos, 0, swapped);
+        }
+
+        if (opcode == _OP_FUNCTION && word_count > 2) {
+            _function_cost_t *functions = (_function_cost_t *)realloc(cost->functions, sizeof(_function_cost_t) * (cost->functions_size + 1));
+
+            if (functions == (_function_cost_t *)0x0) {
+                return spv_cost_fail(&state, cost, "Failed to allocate memory for function cost.");
+            }
+
+            cost->functions = functions;
+            function        = &cost->functions[cost->functions_size++];
+
+            memset(function, 0, sizeof(_function_cost_t));
+
+            function->id    = _OPERAND(data, pos, 1, swapped);
+            loops           = 0;
+            state.start     = state.position + 1;
+            state.defs_size = 0;
+        }
+
+        if (function != (_function_cost_t *)0x0) {
+            unsigned int result   = spv_cost_result(opcode);
+            _cost_e      category = spv_cost_category(data, pos, opcode, word_count, glsl, swapped);
+
+            state.position++;
+
+            function->counts[category]++;
+            function->estimate += (unsigned long long)spv_cost_weights[category] << (_COST_LOOP_SHIFT * (loops < _COST_MAX_LOOPS ? loops : _COST_MAX_LOOPS));
+
+            if (opcode == _OP_LOOP_MERGE && word_count > 1) {
+                if (loops < _COST_MAX_LOOPS)
+                    merges[loops] = _OPERAND(data, pos, 0, swapped);
+
+                loops++;
+
+                if (loops > function->loop_depth)
+                    function->loop_depth = loops;
+            }
+
+            /* A loop ends at its merge block, which follows the loop body in structured control flow.  */
+            if (opcode == _OP_LABEL && word_count > 1) {
+                for (unsigned int i = loops < _COST_MAX_LOOPS ? loops : _COST_MAX_LOOPS; i > 0; --i) {
+                    if (merges[i - 1] == _OPERAND(data, pos, 0, swapped)) {
+                        loops = i - 1;
+                        break;
+                    }
+                }
+            }
+
+            /* Any operand naming an id defined earlier in this function is a use of it. Literals
+               that happen to match an id are counted too, which only makes the estimate conservative.  */
+            for (unsigned int i = result ? result : 1; i < word_count; ++i) {
+                unsigned int id = _OPERAND(data, pos, i - 1, swapped);
+
+                if (i == result || id >= state.ids_size || state.def[id] < state.start)
+                    continue;
+
+                state.last[id] = state.position;
+            }
+
+            if (result != 0 && result < word_count && opcode != _OP_LABEL && _OPERAND(data, pos, result - 1, swapped) < bound) {
+                unsigned int id = _OPERAND(data, pos, result - 1, swapped);
+
+                if (id >= state.ids_size && spv_cost_reserve(&state, id) != 0) {
+                    return spv_cost_fail(&state, cost, "Failed to allocate memory for cost estimate.");
+                }
+
+                if (state.defs_size == state.defs_capacity) {
+                    unsigned long  capacity = state.defs_capacity ? state.defs_capacity * 2 : 64;
+                    unsigned int  *defs     = (unsigned int *)realloc(state.defs, sizeof(unsigned int) * capacity);
+
+                    if (defs == (unsigned int *)0x0) {
+                        return spv_cost_fail(&state, cost, "Failed to allocate memory for cost estimate.");
+                    }
+
+                    state.defs          = defs;
+                    state.defs_capacity = capacity;
+                }
+
+                state.defs[state.defs_size++] = id;
+                state.def[id]                 = state.position;
+                state.last[id]                = state.position;
+            }
+
+            if (opcode == _OP_FUNCTION_END) {
+                if (spv_cost_pressure(&state, function) != 0) {
+                    return spv_cost_fail(&state, cost, "Failed to allocate memory for cost estimate.");
+                }
+
+                function = (_function_cost_t *)0x0;
+            }
+        }
+
+        pos += (word_count - 1) * sizeof(unsigned int);
+    }
+
+    free(state.def);
+    free(state.last);
+    free(state.defs);
+
+    return cost;
+}
+
+/*
+ *    Frees the memory allocated by spv_estimate_cost.
+ *
+ *    @param spv_cost_t *cost    The spv_cost_t struct to free.
+ */
+void spv_free_cost(spv_cost_t *cost) {
+    free(cost->functions);
+    free(cost);
+}
+
+/*
+ *    Converts a byte-swapped spirv module to host byte order in place,
+ *    16 bytes at a time with SSSE3, SSE2 or NEON, whichever the build targets.
+ *
+ *    @param char *data            The spirv binary data to convert.
+ *    @param unsigned long size    The size of the spirv binary data.
+ *
+ *    @return int    1 if the module was swapped, 0 if it was already in host order.
+ */
+int spv_swap_endian(char *data, unsigned long size) {
+    unsigned long pos = 0;
+
+    if (size < sizeof(unsigned int) || *(unsigned int *)data != _MAGIC_SWAPPED)
+        return 0;
+
+    size -= size % sizeof(unsigned int);
+
+#if defined(__SSSE3__)
+    const __m128i shuffle = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i words = _mm_loadu_si128((const __m128i *)(data + pos));
+        _mm_storeu_si128((__m128i *)(data + pos), _mm_shuffle_epi8(words, shuffle));
+    }
+#elif defined(__SSE2__)
+    /* Baseline x86-64 has no byte shuffle: swap the bytes of each half, then the halves.  */
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i words = _mm_loadu_si128((const __m128i *)(data + pos));
+
+        words = _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8));
+        words = _mm_shufflelo_epi16(words, _MM_SHUFFLE(2, 3, 0, 1));
+        words = _mm_shufflehi_epi16(words, _MM_SHUFFLE(2, 3, 0, 1));
+
+        _mm_storeu_si128((__m128i *)(data + pos), words);
+    }
+#elif defined(__ARM_NEON)
+    for (; pos + 16 <= size; pos += 16) {
+        vst1q_u8((uint8_t *)(data + pos), vrev32q_u8(vld1q_u8((const uint8_t *)(data + pos))));
+    }
+#endif
+
+    for (; pos < size; pos += sizeof(unsigned int)) {
+        *(unsigned int *)(data + pos) = spv_bswap(*(unsigned int *)(data + pos));
+    }
+
+    return 1;
+}
+
+/*
+ *    Gets the number of bytes held by a spv_t struct and everything it owns.
+ *
+ *    @param spv_t *spv    The spv_t struct to measure.
+ *
+ *    @return unsigned long    The number of bytes in use.
+ */
+unsigned long spv_memory_usage(spv_t *spv) {
+    unsigned long bytes = sizeof(spv_t);
+
+    bytes += spv->types_size       * sizeof(_type_t);
+    bytes += spv->variables_size   * sizeof(_variable_t);
+    bytes += spv->constants_size   * sizeof(_constant_t);
+    bytes += spv->decorations_size * sizeof(_decoration_t);
+    bytes += spv->names_size       * sizeof(_name_t);
+
+    bytes += spv->member_decorations_size * sizeof(_member_decoration_t);
+    bytes += spv->member_names_size       * sizeof(_member_name_t);
+
+    for (unsigned long i = 0; i < spv->types_size; ++i) {
+        if (spv->types[i].type == _TYPE_STRUCT) {
+            bytes += spv->types[i].struct_type.member_count * sizeof(unsigned int);
+        }
+    }
+
+    for (unsigned long i = 0; i < spv->names_size; ++i) {
+        if (spv->names[i].name != (char *)0x0) {
+            bytes += strlen(spv->names[i].name) + 1;
+        }
+    }
+
+    for (unsigned long i = 0; i < spv->member_names_size; ++i) {
+        if (spv->member_names[i].name != (char *)0x0) {
+            bytes += strlen(spv->member_names[i].name) + 1;
         }
     }
+
+    return bytes;
 }
 
 /*
@@ -524,6 +2314,26 @@ void spv_dump(spv_t *spv) {
  *    @param spv_t *spv    The spv_t struct to free.
  */
 void spv_free(spv_t *spv) {
+    for (unsigned long i = 0; i < spv->types_size; ++i) {
+        if (spv->types[i].type == _TYPE_STRUCT) {
+            free(spv->types[i].struct_type.member_types);
+        }
+    }
+
+    for (unsigned long i = 0; i < spv->names_size; ++i) {
+        free(spv->names[i].name);
+    }
+
+    for (unsigned long i = 0; i < spv->member_names_size; ++i) {
+        free(spv->member_names[i].name);
+    }
+
     free(spv->types);
+    free(spv->variables);
+    free(spv->constants);
+    free(spv->decorations);
+    free(spv->names);
+    free(spv->member_decorations);
+    free(spv->member_names);
     free(spv);
 }
\ No newline at end of file
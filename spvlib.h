@@ -38,6 +38,19 @@ typedef enum {
     _API_TYPE_SAMPLER,
 } _api_type_e;
 
+typedef enum {
+    _DECORATION_BLOCK          = 2,
+    _DECORATION_BUFFER_BLOCK   = 3,
+    _DECORATION_ROW_MAJOR      = 4,
+    _DECORATION_ARRAY_STRIDE   = 6,
+    _DECORATION_MATRIX_STRIDE  = 7,
+    _DECORATION_BUILTIN        = 11,
+    _DECORATION_LOCATION       = 30,
+    _DECORATION_BINDING        = 33,
+    _DECORATION_DESCRIPTOR_SET = 34,
+    _DECORATION_OFFSET         = 35,
+} _decoration_e;
+
 typedef struct {
 
 } _type_void_t;
@@ -141,24 +154,115 @@ typedef struct {
     unsigned int value;
 } _decoration_t;
 
+typedef struct {
+    unsigned int target;
+    unsigned int member;
+    unsigned int decoration;
+    unsigned int value;
+} _member_decoration_t;
+
 typedef struct {
     unsigned int  target;
     char         *name;
 } _name_t;
 
 typedef struct {
-    _type_t       *types;
-    unsigned long  types_size;
-    _variable_t   *variables;
-    unsigned long  variables_size;
-    _constant_t   *constants;
-    unsigned long  constants_size;
-    _decoration_t *decorations;
-    unsigned long  decorations_size;
-    _name_t       *names;
-    unsigned long  names_size;
+    unsigned int  target;
+    unsigned int  member;
+    char         *name;
+} _member_name_t;
+
+typedef enum {
+    _COST_ALU = 0,
+    _COST_TRANSCENDENTAL,
+    _COST_SAMPLE,
+    _COST_LOAD,
+    _COST_STORE,
+    _COST_BARRIER,
+    _COST_BRANCH,
+    _COST_OTHER,
+    _COST_COUNT,
+} _cost_e;
+
+typedef enum {
+    _EXPORT_TEXT = 0,
+    _EXPORT_JSON,
+} _export_format_e;
+
+typedef struct {
+    char          *data;
+    unsigned long  size;
+    unsigned long  capacity;
+} spv_buffer_t;
+
+typedef struct {
+    _type_t              *types;
+    unsigned long         types_size;
+    _variable_t          *variables;
+    unsigned long         variables_size;
+    _constant_t          *constants;
+    unsigned long         constants_size;
+    _decoration_t        *decorations;
+    unsigned long         decorations_size;
+    _name_t              *names;
+    unsigned long         names_size;
+    _member_decoration_t *member_decorations;
+    unsigned long         member_decorations_size;
+    _member_name_t       *member_names;
+    unsigned long         member_names_size;
+    unsigned int          bound;
 } spv_t;
 
+typedef struct {
+    unsigned int       id;
+    unsigned long      counts[_COST_COUNT];
+    unsigned int       loop_depth;
+    unsigned int       pressure;
+    unsigned long long estimate;
+} _function_cost_t;
+
+typedef struct {
+    _function_cost_t *functions;
+    unsigned long     functions_size;
+} spv_cost_t;
+
+#ifdef SPV_ENABLE_STATS
+#define SPV_STATS_OPCODES 512
+
+typedef enum {
+    _SECTION_PREAMBLE = 0,
+    _SECTION_DEBUG,
+    _SECTION_ANNOTATIONS,
+    _SECTION_GLOBALS,
+    _SECTION_FUNCTIONS,
+    _SECTION_COUNT,
+} _section_e;
+
+typedef struct {
+    unsigned long      opcode_counts[SPV_STATS_OPCODES];
+    unsigned long      opcode_other;
+    unsigned long      instructions;
+    unsigned long      words_decoded;
+    unsigned long      words_skipped;
+    unsigned long long section_ns[_SECTION_COUNT];
+    unsigned long      allocations;
+    unsigned long      allocation_bytes;
+    unsigned long      peak_bytes;
+} spv_stats_t;
+
+/*
+ *    Sets the stats struct that spv_parse fills in. The struct is reset at
+ *    the start of every parse, pass a null pointer to stop collecting.
+ *
+ *    Only available when the library is built with SPV_ENABLE_STATS. The
+ *    setting is per thread and only covers parses on the calling thread, so
+ *    threads parsing concurrently, as spv_load_files may, never share one.
+ *
+ *    @param spv_stats_t *stats    The stats struct to fill, or null.
+ */
+void spv_set_stats(spv_stats_t *stats);
+#endif /* SPV_ENABLE_STATS  */
+
 /*
  *    Sets the error callback function.
  *
@@ -167,7 +271,7 @@ typedef struct {
 void spv_set_error_callback(void (*callback)(const char *));
 
 /*
- *    Gets the last error message.
+ *    Gets the last error message raised on the calling thread.
  *
  *    @return const char *    The last error message.
  */
@@ -221,6 +325,88 @@ unsigned int spv_get_uniform_count(spv_t *spv);
  */
 _api_type_e spv_get_uniform_type(spv_t *spv, unsigned int id);
 
+/*
+ *    Looks up the debug name of an id.
+ *
+ *    @param spv_t *spv         The spv_t struct to use.
+ *    @param unsigned int id    The id to look up.
+ *
+ *    @return const char *    The name, or null if there is none.
+ */
+const char *spv_get_name(spv_t *spv, unsigned int id);
+
+/*
+ *    Looks up the debug name of a struct member.
+ *
+ *    @param spv_t *spv             The spv_t struct to use.
+ *    @param unsigned int id        The id of the struct type.
+ *    @param unsigned int member    The index of the member.
+ *
+ *    @return const char *    The name, or null if there is none.
+ */
+const char *spv_get_member_name(spv_t *spv, unsigned int id, unsigned int member);
+
+/*
+ *    Looks up a decoration of an id.
+ *
+ *    @param spv_t *spv                 The spv_t struct to use.
+ *    @param unsigned int id            The decorated id.
+ *    @param _decoration_e decoration   The decoration to look for.
+ *    @param unsigned int *value        Set to the decoration's value if found.
+ *
+ *    @return int    1 if the decoration was found, 0 otherwise.
+ */
+int spv_get_decoration(spv_t *spv, unsigned int id, _decoration_e decoration, unsigned int *value);
+
+/*
+ *    Looks up a decoration of a struct member.
+ *
+ *    @param spv_t *spv                 The spv_t struct to use.
+ *    @param unsigned int id            The id of the struct type.
+ *    @param unsigned int member        The index of the member.
+ *    @param _decoration_e decoration   The decoration to look for.
+ *    @param unsigned int *value        Set to the decoration's value if found.
+ *
+ *    @return int    1 if the decoration was found, 0 otherwise.
+ */
+int spv_get_member_decoration(spv_t *spv, unsigned int id, unsigned int member, _decoration_e decoration, unsigned int *value);
+
+/*
+ *    Looks up the value of a constant.
+ *
+ *    @param spv_t *spv           The spv_t struct to use.
+ *    @param unsigned int id      The id of the constant.
+ *
+ *    @return unsigned int    The value of the constant, or 0 if there is none.
+ */
+unsigned int spv_get_constant(spv_t *spv, unsigned int id);
+
+/*
+ *    Exports the interface of a spv_t struct as GLSL-like text or JSON,
+ *    including names, bindings, locations and block member offsets.
+ *    The output is appended to a growable buffer, which the caller owns
+ *    and releases with free(buffer->data).
+ *
+ *    @param spv_t *spv                 The spv_t struct to export.
+ *    @param _export_format_e format    The output format.
+ *    @param spv_buffer_t *buffer       The buffer to append to.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+int spv_export(spv_t *spv, _export_format_e format, spv_buffer_t *buffer);
+
+/*
+ *    Exports the interface of a spv_t struct as GLSL-like text or JSON
+ *    to a file descriptor, through a single buffered writer.
+ *
+ *    @param spv_t *spv                 The spv_t struct to export.
+ *    @param _export_format_e format    The output format.
+ *    @param int fd                     The file descriptor to write to.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+int spv_export_fd(spv_t *spv, _export_format_e format, int fd);
+
 /*
  *    Dumps the information about the inputs, outputs, and uniforms in a spv_t struct.
  *
@@ -228,6 +414,48 @@ _api_type_e spv_get_uniform_type(spv_t *spv, unsigned int id);
  */
 void spv_dump(spv_t *spv);
 
+/*
+ *    Estimates the cost of every function in a spirv module from its body.
+ *    Instructions are counted per _cost_e category, the deepest loop
+ *    nesting is recorded, and pressure approximates the peak number of ids
+ *    live at once. estimate sums per-category weights, multiplied by 4 for
+ *    every loop level enclosing the instruction.
+ *
+ *    @param const char *data    The spirv binary data to analyze.
+ *    @param unsigned long size  The size of the spirv binary data.
+ *
+ *    @return spv_cost_t *       A pointer to the estimates, or null on failure.
+ */
+spv_cost_t *spv_estimate_cost(const char *data, unsigned long size);
+
+/*
+ *    Frees the memory allocated by spv_estimate_cost.
+ *
+ *    @param spv_cost_t *cost    The spv_cost_t struct to free.
+ */
+void spv_free_cost(spv_cost_t *cost);
+
+/*
+ *    Converts a byte-swapped spirv module to host byte order in place.
+ *    spv_parse and spv_estimate_cost accept swapped modules directly, this
+ *    is only needed to hand a module to code that expects host order.
+ *
+ *    @param char *data            The spirv binary data to convert.
+ *    @param unsigned long size    The size of the spirv binary data.
+ *
+ *    @return int    1 if the module was swapped, 0 if it was already in host order.
+ */
+int spv_swap_endian(char *data, unsigned long size);
+
+/*
+ *    Gets the number of bytes held by a spv_t struct and everything it owns.
+ *
+ *    @param spv_t *spv    The spv_t struct to measure.
+ *
+ *    @return unsigned long    The number of bytes in use.
+ */
+unsigned long spv_memory_usage(spv_t *spv);
+
 /*
  *    Frees the memory allocated by spv_parse.
  *
@@ -0,0 +1,590 @@
+/*
+ *    spvload.c    --    Source file for SPV batch loader
+ *
+ *    This file is part of the SPV library.
+ *
+ *    This file defines the functions used to load and parse many spirv
+ *    modules at once. On Linux, reads are queued on an io_uring and each
+ *    module is parsed on the calling thread as soon as its read completes,
+ *    while the remaining reads are still in flight. Where io_uring is not
+ *    available, or when built with SPV_LOAD_NO_IO_URING, a pool of threads
+ *    each read and parse modules with blocking reads instead. Either way the
+ *    read buffers come from a fixed pool and are reused across modules.
+ */
+#include "spvload.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__linux__) && !defined(SPV_LOAD_NO_IO_URING)
+#define _LOAD_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#define _LOAD_SLOTS   32
+#define _LOAD_THREADS 8
+
+typedef struct {
+    int            fd;
+    unsigned long  index;
+    char          *data;
+    unsigned long  capacity;
+    unsigned long  size;
+    unsigned long  done;
+    int            busy;
+} _slot_t;
+
+typedef struct {
+    const char          **paths;
+    unsigned long         count;
+    unsigned long         next;
+    spv_load_callback_t   callback;
+    void                 *user;
+    pthread_mutex_t       lock;
+} _pool_t;
+
+/*
+ *    Opens a module and makes sure a slot's buffer can hold it.
+ *
+ *    @param _slot_t *slot        The slot to load into.
+ *    @param const char *path     The path of the module.
+ *    @param const char **error   Set to the reason on failure.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spv_load_open(_slot_t *slot, const char *path, const char **error) {
+    struct stat st;
+
+    slot->fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (slot->fd < 0) {
+        *error = "Failed to open module.";
+        return -1;
+    }
+
+    if (fstat(slot->fd, &st) != 0) {
+        close(slot->fd);
+        slot->fd = -1;
+        *error   = "Failed to stat module.";
+        return -1;
+    }
+
+    slot->size = st.st_size;
+    slot->done = 0;
+
+    if (slot->size > slot->capacity) {
+        char *data = (char *)realloc(slot->data, slot->size);
+
+        if (data == (char *)0x0) {
+            close(slot->fd);
+            slot->fd = -1;
+            *error   = "Failed to allocate memory for module.";
+            return -1;
+        }
+
+        slot->data     = data;
+        slot->capacity = slot->size;
+    }
+
+    return 0;
+}
+
+/*
+ *    Reads the rest of a slot's module with blocking reads.
+ *
+ *    @param _slot_t *slot        The slot to read into.
+ *    @param const char **error   Set to the reason on failure.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spv_load_read(_slot_t *slot, const char **error) {
+    while (slot->done < slot->size) {
+        long bytes = pread(slot->fd, slot->data + slot->done, slot->size - slot->done, slot->done);
+
+        if (bytes < 0 && errno == EINTR)
+            continue;
+
+        if (bytes < 0) {
+            *error = "Failed to read module.";
+            return -1;
+        }
+
+        /* The file shrank since it was opened, parse what is there.  */
+        if (bytes == 0)
+            slot->size = slot->done;
+
+        slot->done += bytes;
+    }
+
+    return 0;
+}
+
+/*
+ *    Loads modules from a shared queue until it is empty.
+ *
+ *    @param void *arg    The _pool_t to work on.
+ *
+ *    @return void *    Always null.
+ */
+static void *spv_load_worker(void *arg) {
+    _pool_t *pool = (_pool_t *)arg;
+    _slot_t  slot = { -1, 0, (char *)0x0, 0, 0, 0, 0 };
+
+    for (;;) {
+        unsigned long index = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+
+        if (index >= pool->count)
+            break;
+
+        const char *error = (const char *)0x0;
+        spv_t      *spv   = (spv_t *)0x0;
+
+        if (spv_load_open(&slot, pool->paths[index], &error) == 0) {
+            if (spv_load_read(&slot, &error) == 0) {
+                spv = spv_parse(slot.data, slot.size);
+
+                if (spv == (spv_t *)0x0)
+                    error = spv_get_last_error();
+            }
+
+            close(slot.fd);
+            slot.fd = -1;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        pool->callback(pool->paths[index], spv, error, pool->user);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    free(slot.data);
+
+    return (void *)0x0;
+}
+
+/*
+ *    Loads modules with a pool of threads doing blocking reads.
+ *
+ *    @param const char **paths            The paths of the modules.
+ *    @param unsigned long count           The number of paths.
+ *    @param spv_load_callback_t callback  Called with each parsed module.
+ *    @param void *user                    Passed through to the callback.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spv_load_threads(const char **paths, unsigned long count, spv_load_callback_t callback, void *user) {
+    pthread_t     threads[_LOAD_THREADS];
+    unsigned long created = 0;
+    long          cores   = sysconf(_SC_NPROCESSORS_ONLN);
+    _pool_t       pool;
+
+    pool.paths    = paths;
+    pool.count    = count;
+    pool.next     = 0;
+    pool.callback = callback;
+    pool.user     = user;
+
+    if (pthread_mutex_init(&pool.lock, (const pthread_mutexattr_t *)0x0) != 0)
+        return -1;
+
+    /* The calling thread is one of the workers.  */
+    unsigned long workers = cores > 0 ? (unsigned long)cores : 1;
+
+    if (workers > _LOAD_THREADS)
+        workers = _LOAD_THREADS;
+
+    if (workers > count)
+        workers = count;
+
+    for (; created + 1 < workers; ++created) {
+        if (pthread_create(&threads[created], (const pthread_attr_t *)0x0, spv_load_worker, &pool) != 0)
+            break;
+    }
+
+    spv_load_worker(&pool);
+
+    for (unsigned long i = 0; i < created; ++i) {
+        pthread_join(threads[i], (void **)0x0);
+    }
+
+    pthread_mutex_destroy(&pool.lock);
+
+    return 0;
+}
+
+#ifdef _LOAD_IO_URING
+/*
+ *    Parses a fully read module and hands it to the callback.
+ *
+ *    @param _slot_t *slot                 The slot holding the module.
+ *    @param const char *path              The path of the module.
+ *    @param spv_load_callback_t callback  The callback to call.
+ *    @param void *user                    Passed through to the callback.
+ */
+static void spv_load_finish(_slot_t *slot, const char *path, spv_load_callback_t callback, void *user) {
+    close(slot->fd);
+    slot->fd = -1;
+
+    spv_t *spv = spv_parse(slot->data, slot->size);
+
+    callback(path, spv, spv != (spv_t *)0x0 ? (const char *)0x0 : spv_get_last_error(), user);
+}
+
+typedef struct {
+    int                  fd;
+    unsigned int         entries;
+    unsigned int        *sq_head;
+    unsigned int        *sq_tail;
+    unsigned int        *sq_mask;
+    unsigned int        *sq_array;
+    unsigned int        *cq_head;
+    unsigned int        *cq_tail;
+    unsigned int        *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void                *sq_ring;
+    unsigned long        sq_ring_size;
+    void                *cq_ring;
+    unsigned long        cq_ring_size;
+    unsigned long        sqes_size;
+} _ring_t;
+
+/*
+ *    Unmaps and closes an io_uring.
+ *
+ *    @param _ring_t *ring    The ring to close.
+ */
+static void spv_ring_close(_ring_t *ring) {
+    if (ring->sqes != (struct io_uring_sqe *)MAP_FAILED && ring->sqes != (struct io_uring_sqe *)0x0)
+        munmap(ring->sqes, ring->sqes_size);
+
+    if (ring->cq_ring != ring->sq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != (void *)0x0)
+        munmap(ring->cq_ring, ring->cq_ring_size);
+
+    if (ring->sq_ring != MAP_FAILED && ring->sq_ring != (void *)0x0)
+        munmap(ring->sq_ring, ring->sq_ring_size);
+
+    close(ring->fd);
+}
+
+/*
+ *    Creates an io_uring and maps its queues.
+ *
+ *    @param _ring_t *ring          The ring to set up.
+ *    @param unsigned int entries   The number of submission queue entries.
+ *
+ *    @return int    0 on success, -1 if io_uring is unavailable.
+ */
+static int spv_ring_open(_ring_t *ring, unsigned int entries) {
+    struct io_uring_params params;
+
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(_ring_t));
+
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+
+    if (ring->fd < 0)
+        return -1;
+
+    ring->entries      = params.sq_entries;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size    = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size)
+            ring->sq_ring_size = ring->cq_ring_size;
+
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap((void *)0x0, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq_ring = ring->sq_ring;
+    else
+        ring->cq_ring = mmap((void *)0x0, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+
+    ring->sqes = (struct io_uring_sqe *)mmap((void *)0x0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == (struct io_uring_sqe *)MAP_FAILED) {
+        spv_ring_close(ring);
+        return -1;
+    }
+
+    ring->sq_head  = (unsigned int *)((char *)ring->sq_ring + params.sq_off.head);
+    ring->sq_tail  = (unsigned int *)((char *)ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask  = (unsigned int *)((char *)ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *)((char *)ring->sq_ring + params.sq_off.array);
+    ring->cq_head  = (unsigned int *)((char *)ring->cq_ring + params.cq_off.head);
+    ring->cq_tail  = (unsigned int *)((char *)ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask  = (unsigned int *)((char *)ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes     = (struct io_uring_cqe *)((char *)ring->cq_ring + params.cq_off.cqes);
+
+    return 0;
+}
+
+/*
+ *    Queues a read of the rest of a slot's module.
+ *
+ *    @param _ring_t *ring          The ring to queue on.
+ *    @param _slot_t *slot          The slot to read into.
+ *    @param unsigned long index    The index of the slot, returned with the completion.
+ *
+ *    @return int    0 on success, -1 if the submission queue is full.
+ */
+static int spv_ring_read(_ring_t *ring, _slot_t *slot, unsigned long index) {
+    unsigned int tail = *ring->sq_tail;
+    unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= ring->entries)
+        return -1;
+
+    unsigned int         entry = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe   = &ring->sqes[entry];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = slot->fd;
+    sqe->addr      = (unsigned long)(slot->data + slot->done);
+    sqe->len       = slot->size - slot->done;
+    sqe->off       = slot->done;
+    sqe->user_data = index;
+
+    ring->sq_array[entry] = entry;
+
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/*
+ *    Loads modules through an io_uring, parsing each as its read completes.
+ *
+ *    @param _ring_t *ring                 The ring to use.
+ *    @param const char **paths            The paths of the modules.
+ *    @param unsigned long count           The number of paths.
+ *    @param spv_load_callback_t callback  Called with each parsed module.
+ *    @param void *user                    Passed through to the callback.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spv_load_ring(_ring_t *ring, const char **paths, unsigned long count, spv_load_callback_t callback, void *user) {
+    _slot_t       slots[_LOAD_SLOTS];
+    unsigned long next    = 0;
+    unsigned long busy    = 0;
+    unsigned int  queued  = 0;
+    int           status  = 0;
+
+    for (unsigned long i = 0; i < _LOAD_SLOTS; ++i) {
+        slots[i].fd       = -1;
+        slots[i].data     = (char *)0x0;
+        slots[i].capacity = 0;
+        slots[i].busy     = 0;
+    }
+
+    while (next < count || busy > 0) {
+        for (unsigned long i = 0; i < _LOAD_SLOTS && next < count; ++i) {
+            const char *error = (const char *)0x0;
+
+            if (slots[i].busy)
+                continue;
+
+            if (spv_load_open(&slots[i], paths[next], &error) != 0) {
+                callback(paths[next++], (spv_t *)0x0, error, user);
+                continue;
+            }
+
+            slots[i].index = next++;
+
+            if (slots[i].size == 0) {
+                spv_load_finish(&slots[i], paths[slots[i].index], callback, user);
+                continue;
+            }
+
+            if (spv_ring_read(ring, &slots[i], i) != 0) {
+                close(slots[i].fd);
+                next = slots[i].index;
+                break;
+            }
+
+            slots[i].busy = 1;
+            busy++;
+            queued++;
+        }
+
+        if (busy == 0)
+            continue;
+
+        int submitted = syscall(__NR_io_uring_enter, ring->fd, queued, 1, IORING_ENTER_GETEVENTS, (void *)0x0, 0);
+
+        if (submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+            continue;
+
+        if (submitted < 0) {
+            status = -1;
+            break;
+        }
+
+        queued -= submitted;
+
+        unsigned int head = *ring->cq_head;
+        unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head) {
+            struct io_uring_cqe *cqe    = &ring->cqes[head & *ring->cq_mask];
+            _slot_t             *slot   = &slots[cqe->user_data];
+            int                  result = cqe->res;
+            const char          *error  = (const char *)0x0;
+
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+            /* Kernels without IORING_OP_READ, among other errors, finish the read synchronously.  */
+            if (result < 0) {
+                if (spv_load_read(slot, &error) != 0) {
+                    close(slot->fd);
+                    slot->fd   = -1;
+                    slot->busy = 0;
+                    busy--;
+
+                    callback(paths[slot->index], (spv_t *)0x0, error, user);
+                    continue;
+                }
+            } else if (result == 0) {
+                slot->size = slot->done;
+            } else {
+                slot->done += result;
+            }
+
+            if (slot->done < slot->size && spv_ring_read(ring, slot, slot - slots) == 0) {
+                queued++;
+                continue;
+            }
+
+            if (slot->done < slot->size && spv_load_read(slot, &error) != 0) {
+                close(slot->fd);
+                slot->fd = -1;
+
+                callback(paths[slot->index], (spv_t *)0x0, error, user);
+            } else {
+                spv_load_finish(slot, paths[slot->index], callback, user);
+            }
+
+            slot->busy = 0;
+            busy--;
+        }
+    }
+
+    spv_ring_close(ring);
+
+    for (unsigned long i = 0; i < _LOAD_SLOTS; ++i) {
+        /* A read may still be in flight after a failed io_uring_enter, so its buffer is left alone.  */
+        if (slots[i].busy) {
+            close(slots[i].fd);
+            continue;
+        }
+
+        free(slots[i].data);
+    }
+
+    return status;
+}
+#endif /* _LOAD_IO_URING  */
+
+/*
+ *    Loads and parses a list of spirv modules, overlapping reads with parsing.
+ *
+ *    @param const char **paths            The paths of the modules.
+ *    @param unsigned long count           The number of paths.
+ *    @param spv_load_callback_t callback  Called with each parsed module.
+ *    @param void *user                    Passed through to the callback.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+int spv_load_files(const char **paths, unsigned long count, spv_load_callback_t callback, void *user) {
+    if (count == 0)
+        return 0;
+
+#ifdef _LOAD_IO_URING
+    _ring_t ring;
+
+    if (spv_ring_open(&ring, _LOAD_SLOTS) == 0)
+        return spv_load_ring(&ring, paths, count, callback, user);
+#endif /* _LOAD_IO_URING  */
+
+    return spv_load_threads(paths, count, callback, user);
+}
+
+/*
+ *    Loads and parses every .spv file in a directory.
+ *
+ *    @param const char *path              The path of the directory.
+ *    @param spv_load_callback_t callback  Called with each parsed module.
+ *    @param void *user                    Passed through to the callback.
+ *
+ *    @return int    0 on success, -1 if the directory could not be read.
+ */
+int spv_load_directory(const char *path, spv_load_callback_t callback, void *user) {
+    DIR           *dir      = opendir(path);
+    char         **paths    = (char **)0x0;
+    unsigned long  count    = 0;
+    unsigned long  capacity = 0;
+    int            status   = 0;
+
+    if (dir == (DIR *)0x0)
+        return -1;
+
+    for (struct dirent *entry = readdir(dir); entry != (struct dirent *)0x0; entry = readdir(dir)) {
+        unsigned long length = strlen(entry->d_name);
+
+        if (length <= 4 || strcmp(entry->d_name + length - 4, ".spv") != 0)
+            continue;
+
+        if (count == capacity) {
+            capacity     = capacity ? capacity * 2 : 64;
+            char **grown = (char **)realloc(paths, sizeof(char *) * capacity);
+
+            if (grown == (char **)0x0) {
+                status = -1;
+                break;
+            }
+
+            paths = grown;
+        }
+
+        unsigned long prefix = strlen(path);
+        char         *file   = (char *)malloc(prefix + length + 2);
+
+        if (file == (char *)0x0) {
+            status = -1;
+            break;
+        }
+
+        memcpy(file, path, prefix);
+        file[prefix] = '/';
+        memcpy(file + prefix + 1, entry->d_name, length + 1);
+
+        paths[count++] = file;
+    }
+
+    closedir(dir);
+
+    if (status == 0)
+        status = spv_load_files((const char **)paths, count, callback, user);
+
+    for (unsigned long i = 0; i < count; ++i) {
+        free(paths[i]);
+    }
+
+    free(paths);
+
+    return status;
+}
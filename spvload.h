@@ -0,0 +1,51 @@
+/*
+ *    spvload.h    --    Header file for SPV batch loader
+ *
+ *    This file is part of the SPV library.
+ *
+ *    This file declares the functions used to load and parse many spirv
+ *    modules at once, overlapping file reads with parsing.
+ */
+#ifndef _SPVLOAD_H
+#define _SPVLOAD_H
+
+#include "spvlib.h"
+
+/*
+ *    Called once for every module loaded by spv_load_files or spv_load_directory.
+ *    Calls are never concurrent, but may come from worker threads.
+ *
+ *    @param const char *path     The path of the module.
+ *    @param spv_t *spv           The parsed module, owned by the callback, or null on failure.
+ *    @param const char *error    The reason the module failed to load, or null.
+ *    @param void *user           The user pointer passed to the loader.
+ */
+typedef void (*spv_load_callback_t)(const char *path, spv_t *spv, const char *error, void *user);
+
+/*
+ *    Loads and parses a list of spirv modules. Reads are issued through
+ *    io_uring where available, falling back to a thread pool, into a fixed
+ *    pool of recycled buffers. Each module is parsed as soon as its read
+ *    completes, while the other reads are still in flight.
+ *
+ *    @param const char **paths            The paths of the modules.
+ *    @param unsigned long count           The number of paths.
+ *    @param spv_load_callback_t callback  Called with each parsed module.
+ *    @param void *user                    Passed through to the callback.
+ *
+ *    @return int    0 on success, -1 if loading stopped early.
+ */
+int spv_load_files(const char **paths, unsigned long count, spv_load_callback_t callback, void *user);
+
+/*
+ *    Loads and parses every .spv file in a directory, as spv_load_files.
+ *
+ *    @param const char *path              The path of the directory.
+ *    @param spv_load_callback_t callback  Called with each parsed module.
+ *    @param void *user                    Passed through to the callback.
+ *
+ *    @return int    0 on success, -1 if the directory could not be read.
+ */
+int spv_load_directory(const char *path, spv_load_callback_t callback, void *user);
+
+#endif /* _SPVLOAD_H  */
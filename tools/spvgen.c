@@ -0,0 +1,823 @@
+/*
+ *    spvgen.c    --    Source file for the SPV header generator
+ *
+ *    This file is part of the SPV library.
+ *
+ *    This file defines an offline tool that reads spirv modules and emits a
+ *    C header describing their interface: descriptor bindings, input and
+ *    output locations, and a C struct for every uniform, storage and push
+ *    constant block whose layout matches the module, with static asserts on
+ *    every member offset and struct size. Counts, sizes and offsets are enum
+ *    constants and the tables are constexpr in C++, so shaders embedded at
+ *    build time can be checked at compile time without calling spv_parse.
+ *
+ *    Usage:
+ *        cc -I.. spvgen.c ../spvlib.c -o spvgen
+ *        ./spvgen [-o output.h] shader.spv ...
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spvlib.h"
+
+#define _GEN_MAX_DIMS       8
+#define _GEN_MAX_DEPTH      16
+#define _GEN_NAME_SIZE      256
+#define _GEN_MAX_SIZE       0x7FFFFFFF
+
+typedef struct {
+    spv_t         *spv;
+    FILE          *out;
+    const char    *prefix;
+    unsigned int  *emitted;
+    unsigned long  emitted_size;
+} _gen_t;
+
+typedef struct {
+    char          base[_GEN_NAME_SIZE];
+    unsigned int  dims[_GEN_MAX_DIMS];
+    unsigned int  dims_size;
+    unsigned int  scalar;
+    unsigned long size;
+} _layout_t;
+
+/*
+ *    Looks up a type by its result id.
+ *
+ *    @param spv_t *spv         The spv_t struct to use.
+ *    @param unsigned int id    The id of the type.
+ *
+ *    @return _type_t *    The type, or null if there is none.
+ */
+static _type_t *spvgen_type(spv_t *spv, unsigned int id) {
+    for (unsigned long i = 0; i < spv->types_size; ++i) {
+        if (spv->types[i].id == id) {
+            return &spv->types[i];
+        }
+    }
+
+    return (_type_t *)0x0;
+}
+
+/*
+ *    Copies a name into a buffer as a valid C identifier.
+ *
+ *    @param char *buffer           The buffer to write to.
+ *    @param unsigned long size     The size of the buffer.
+ *    @param const char *name       The name to copy, or null.
+ *    @param const char *fallback   The prefix used when there is no name.
+ *    @param unsigned int id        The id appended to the fallback.
+ */
+static void spvgen_identifier(char *buffer, unsigned long size, const char *name, const char *fallback, unsigned int id) {
+    if (name == (const char *)0x0) {
+        snprintf(buffer, size, "%s%u", fallback, id);
+        return;
+    }
+
+    unsigned long i = 0;
+
+    if (name[0] >= '0' && name[0] <= '9' && i + 1 < size)
+        buffer[i++] = '_';
+
+    for (; *name != '\0' && i + 1 < size; ++name) {
+        char c = *name;
+
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')))
+            c = '_';
+
+        buffer[i++] = c;
+    }
+
+    buffer[i] = '\0';
+}
+
+/*
+ *    Gets the C name of a struct type.
+ *
+ *    @param _gen_t *gen          The generator state.
+ *    @param unsigned int id      The id of the struct type.
+ *    @param char *buffer         The buffer to write to.
+ *    @param unsigned long size   The size of the buffer.
+ *
+ *    @return int    0 on success, -1 if the name does not fit.
+ */
+static int spvgen_struct_name(_gen_t *gen, unsigned int id, char *buffer, unsigned long size) {
+    char name[_GEN_NAME_SIZE];
+    char other[_GEN_NAME_SIZE];
+
+    spvgen_identifier(name, sizeof(name), spv_get_name(gen->spv, id), "struct", id);
+
+    /* glslang names the std140 and std430 copies of a struct alike, so a struct
+       whose name is taken by an earlier one gets its id appended.  */
+    for (unsigned long i = 0; i < gen->spv->types_size && gen->spv->types[i].id != id; ++i) {
+        if (gen->spv->types[i].type != _TYPE_STRUCT)
+            continue;
+
+        spvgen_identifier(other, sizeof(other), spv_get_name(gen->spv, gen->spv->types[i].id), "struct", gen->spv->types[i].id);
+
+        if (strcmp(name, other) == 0) {
+            unsigned long length = strlen(name);
+
+            if ((unsigned long)snprintf(name + length, sizeof(name) - length, "_%u", id) >= sizeof(name) - length)
+                return -1;
+
+            break;
+        }
+    }
+
+    /* A truncated name could collide with another one, so it is an error.  */
+    if ((unsigned long)snprintf(buffer, size, "%s_%s", gen->prefix, name) >= size)
+        return -1;
+
+    return 0;
+}
+
+/*
+ *    Inserts an array dimension into a layout.
+ *
+ *    @param _layout_t *layout    The layout to insert into.
+ *    @param unsigned int index   The position of the new dimension.
+ *    @param unsigned int dim     The size of the dimension.
+ *
+ *    @return int    0 on success, -1 if the layout has too many dimensions.
+ */
+static int spvgen_insert_dim(_layout_t *layout, unsigned int index, unsigned int dim) {
+    if (layout->dims_size >= _GEN_MAX_DIMS || index > layout->dims_size)
+        return -1;
+
+    memmove(&layout->dims[index + 1], &layout->dims[index], (layout->dims_size - index) * sizeof(unsigned int));
+
+    layout->dims[index] = dim;
+    layout->dims_size++;
+
+    return 0;
+}
+
+/*
+ *    Gets the largest ArrayStride of any array of a struct type, so the
+ *    struct can be padded to it and arrays of it declared directly.
+ *
+ *    @param spv_t *spv         The spv_t struct to use.
+ *    @param unsigned int id    The id of the struct type.
+ *
+ *    @return unsigned int    The largest stride, or 0 if the struct is never an array element.
+ */
+static unsigned int spvgen_struct_stride(spv_t *spv, unsigned int id) {
+    unsigned int largest = 0;
+
+    for (unsigned long i = 0; i < spv->types_size; ++i) {
+        _type_t     *type    = &spv->types[i];
+        unsigned int element = 0;
+        unsigned int stride  = 0;
+
+        if (type->type == _TYPE_ARRAY)
+            element = type->array_type.element_type;
+        else if (type->type == _TYPE_RUNTIME_ARRAY)
+            element = type->runtime_array_type.element_type;
+
+        if (element != id || element == 0)
+            continue;
+
+        if (spv_get_decoration(spv, type->id, _DECORATION_ARRAY_STRIDE, &stride) && stride > largest)
+            largest = stride;
+    }
+
+    return largest;
+}
+
+static int spvgen_emit_struct(_gen_t *gen, unsigned int id, unsigned int depth);
+
+/*
+ *    Computes the C declaration and size of a type laid out as in the module.
+ *
+ *    @param _gen_t *gen                  The generator state.
+ *    @param unsigned int id              The id of the type.
+ *    @param unsigned int matrix_stride   The member's MatrixStride, or 0.
+ *    @param int row_major                Whether the member is RowMajor.
+ *    @param unsigned int depth           The nesting depth.
+ *    @param _layout_t *layout            Set to the layout of the type.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spvgen_layout(_gen_t *gen, unsigned int id, unsigned int matrix_stride, int row_major, unsigned int depth, _layout_t *layout) {
+    _type_t *type = spvgen_type(gen->spv, id);
+
+    if (type == (_type_t *)0x0 || depth > _GEN_MAX_DEPTH)
+        return -1;
+
+    switch (type->type) {
+        case _TYPE_BOOL: {
+            strcpy(layout->base, "uint32_t");
+            layout->dims_size = 0;
+            layout->scalar    = 4;
+            layout->size      = 4;
+        } break;
+
+        case _TYPE_INT: {
+            snprintf(layout->base, sizeof(layout->base), "%sint%u_t", type->int_type.signedness ? "" : "u", type->int_type.width);
+            layout->dims_size = 0;
+            layout->scalar    = type->int_type.width / 8;
+            layout->size      = layout->scalar;
+        } break;
+
+        case _TYPE_FLOAT: {
+            if (type->float_type.width == 64)
+                strcpy(layout->base, "double");
+            else if (type->float_type.width == 16)
+                strcpy(layout->base, "uint16_t");
+            else
+                strcpy(layout->base, "float");
+
+            layout->dims_size = 0;
+            layout->scalar    = type->float_type.width / 8;
+            layout->size      = layout->scalar;
+        } break;
+
+        case _TYPE_VECTOR: {
+            /* Components must be scalars, nested vectors would stack dimensions without bound.  */
+            if (spvgen_layout(gen, type->vector_type.component_type, 0, 0, depth + 1, layout) != 0 || layout->dims_size != 0 || layout->scalar == 0)
+                return -1;
+
+            if (spvgen_insert_dim(layout, layout->dims_size, type->vector_type.component_count) != 0)
+                return -1;
+
+            layout->size *= type->vector_type.component_count;
+        } break;
+
+        case _TYPE_MATRIX: {
+            _type_t *column = spvgen_type(gen->spv, type->matrix_type.column_type);
+
+            if (column == (_type_t *)0x0 || column->type != _TYPE_VECTOR)
+                return -1;
+
+            if (spvgen_layout(gen, column->vector_type.component_type, 0, 0, depth + 1, layout) != 0 || layout->dims_size != 0 || layout->scalar == 0)
+                return -1;
+
+            unsigned int rows    = column->vector_type.component_count;
+            unsigned int columns = type->matrix_type.column_count;
+            unsigned int stride  = matrix_stride ? matrix_stride : (row_major ? columns : rows) * layout->scalar;
+
+            /* The outer dimension is whichever of columns or rows the stride applies to.  */
+            if (spvgen_insert_dim(layout, 0, row_major ? rows : columns) != 0 || spvgen_insert_dim(layout, 1, stride / layout->scalar) != 0)
+                return -1;
+
+            layout->size = (unsigned long)(row_major ? rows : columns) * stride;
+        } break;
+
+        case _TYPE_ARRAY:
+        case _TYPE_RUNTIME_ARRAY: {
+            unsigned int element = type->type == _TYPE_ARRAY ? type->array_type.element_type : type->runtime_array_type.element_type;
+            unsigned int length  = type->type == _TYPE_ARRAY ? spv_get_constant(gen->spv, type->array_type.length) : 0;
+            unsigned int stride  = 0;
+
+            if (spvgen_layout(gen, element, matrix_stride, row_major, depth + 1, layout) != 0)
+                return -1;
+
+            if (!spv_get_decoration(gen->spv, type->id, _DECORATION_ARRAY_STRIDE, &stride))
+                stride = layout->size;
+
+            if (stride != layout->size) {
+                /* Padded elements: widen the innermost dimension of scalars and vectors, fall back to bytes.  */
+                if (layout->dims_size <= 1 && layout->scalar != 0 && stride % layout->scalar == 0) {
+                    layout->dims[0]   = stride / layout->scalar;
+                    layout->dims_size = 1;
+                } else {
+                    strcpy(layout->base, "uint8_t");
+                    layout->dims[0]   = stride;
+                    layout->dims_size = 1;
+                }
+            }
+
+            if (spvgen_insert_dim(layout, 0, length) != 0)
+                return -1;
+
+            layout->size = (unsigned long)length * stride;
+        } break;
+
+        case _TYPE_STRUCT: {
+            if (spvgen_emit_struct(gen, type->id, depth + 1) != 0)
+                return -1;
+
+            if (spvgen_struct_name(gen, type->id, layout->base, sizeof(layout->base)) != 0)
+                return -1;
+
+            layout->dims_size = 0;
+            layout->scalar    = 0;
+            layout->size      = 0;
+
+            for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+                _layout_t    member;
+                unsigned int offset = 0;
+                unsigned int stride = 0;
+
+                spv_get_member_decoration(gen->spv, type->id, i, _DECORATION_OFFSET, &offset);
+                spv_get_member_decoration(gen->spv, type->id, i, _DECORATION_MATRIX_STRIDE, &stride);
+
+                if (spvgen_layout(gen, type->struct_type.member_types[i], stride, spv_get_member_decoration(gen->spv, type->id, i, _DECORATION_ROW_MAJOR, &stride), depth + 1, &member) != 0)
+                    return -1;
+
+                if (offset + member.size > layout->size)
+                    layout->size = offset + member.size;
+            }
+
+            unsigned int stride = spvgen_struct_stride(gen->spv, type->id);
+
+            if (stride > layout->size)
+                layout->size = stride;
+        } break;
+
+        default: {
+            return -1;
+        } break;
+    }
+
+    return 0;
+}
+
+/*
+ *    Emits a C struct matching the layout of a struct type, along with its
+ *    member table and offset asserts. Nested structs are emitted first.
+ *
+ *    @param _gen_t *gen            The generator state.
+ *    @param unsigned int id        The id of the struct type.
+ *    @param unsigned int depth     The nesting depth.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spvgen_emit_struct(_gen_t *gen, unsigned int id, unsigned int depth) {
+    _type_t      *type = spvgen_type(gen->spv, id);
+    char          name[_GEN_NAME_SIZE];
+    char          member_names[64][_GEN_NAME_SIZE];
+    _layout_t     layouts[64];
+    unsigned int  offsets[64];
+    unsigned long cursor = 0;
+    unsigned int  pads   = 0;
+
+    if (type == (_type_t *)0x0 || type->type != _TYPE_STRUCT || depth > _GEN_MAX_DEPTH)
+        return -1;
+
+    if (type->struct_type.member_count > 64) {
+        fprintf(stderr, "spvgen: struct %u has too many members\n", id);
+        return -1;
+    }
+
+    for (unsigned long i = 0; i < gen->emitted_size; ++i) {
+        if (gen->emitted[i] == id)
+            return 0;
+    }
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        unsigned int stride = 0;
+        unsigned int value  = 0;
+
+        offsets[i] = 0;
+
+        if (!spv_get_member_decoration(gen->spv, id, i, _DECORATION_OFFSET, &offsets[i]) && i > 0) {
+            fprintf(stderr, "spvgen: member %u of struct %u has no offset\n", i, id);
+            return -1;
+        }
+
+        spv_get_member_decoration(gen->spv, id, i, _DECORATION_MATRIX_STRIDE, &stride);
+
+        if (spvgen_layout(gen, type->struct_type.member_types[i], stride, spv_get_member_decoration(gen->spv, id, i, _DECORATION_ROW_MAJOR, &value), depth + 1, &layouts[i]) != 0) {
+            fprintf(stderr, "spvgen: member %u of struct %u has an unsupported type\n", i, id);
+            return -1;
+        }
+
+        if (i > 0 && offsets[i] < offsets[i - 1] + layouts[i - 1].size) {
+            fprintf(stderr, "spvgen: member %u of struct %u overlaps the previous member\n", i, id);
+            return -1;
+        }
+
+        spvgen_identifier(member_names[i], sizeof(member_names[i]), spv_get_member_name(gen->spv, id, i), "member", i);
+
+        /* Offsets and sizes are emitted as enum constants, which must fit in an int.  */
+        if (offsets[i] + layouts[i].size > _GEN_MAX_SIZE) {
+            fprintf(stderr, "spvgen: member %u of struct %u is too large\n", i, id);
+            return -1;
+        }
+    }
+
+    /* Tail padding up to the array stride, so arrays of the struct match the module.  */
+    unsigned int stride = spvgen_struct_stride(gen->spv, id);
+
+    if (stride > _GEN_MAX_SIZE) {
+        fprintf(stderr, "spvgen: struct %u is too large\n", id);
+        return -1;
+    }
+
+    unsigned int *emitted = (unsigned int *)realloc(gen->emitted, sizeof(unsigned int) * (gen->emitted_size + 1));
+
+    if (emitted == (unsigned int *)0x0)
+        return -1;
+
+    gen->emitted                      = emitted;
+    gen->emitted[gen->emitted_size++] = id;
+
+    if (spvgen_struct_name(gen, id, name, sizeof(name)) != 0) {
+        fprintf(stderr, "spvgen: the name of struct %u is too long\n", id);
+        return -1;
+    }
+
+    fprintf(gen->out, "typedef struct {\n");
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        if (offsets[i] > cursor)
+            fprintf(gen->out, "    uint8_t _pad%u[%lu];\n", pads++, offsets[i] - cursor);
+
+        fprintf(gen->out, "    %s %s", layouts[i].base, member_names[i]);
+
+        for (unsigned int j = 0; j < layouts[i].dims_size; ++j) {
+            if (layouts[i].dims[j] == 0)
+                fprintf(gen->out, "[]");
+            else
+                fprintf(gen->out, "[%u]", layouts[i].dims[j]);
+        }
+
+        fprintf(gen->out, ";\n");
+
+        cursor = offsets[i] + layouts[i].size;
+    }
+
+    if (stride > cursor) {
+        fprintf(gen->out, "    uint8_t _pad%u[%lu];\n", pads++, stride - cursor);
+        cursor = stride;
+    }
+
+    fprintf(gen->out, "} %s;\n\n", name);
+
+    fprintf(gen->out, "enum {\n");
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        fprintf(gen->out, "    %s_%s_offset = %u,\n", name, member_names[i], offsets[i]);
+    }
+
+    fprintf(gen->out, "    %s_member_count = %u,\n", name, type->struct_type.member_count);
+    fprintf(gen->out, "    %s_size = %lu,\n};\n\n", name, cursor);
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        fprintf(gen->out, "SPVGEN_STATIC_ASSERT(offsetof(%s, %s) == %s_%s_offset, \"%s.%s offset\");\n", name, member_names[i], name, member_names[i], name, member_names[i]);
+    }
+
+    fprintf(gen->out, "SPVGEN_STATIC_ASSERT(sizeof(%s) == %s_size, \"%s size\");\n", name, name, name);
+
+    fprintf(gen->out, "\nstatic SPVGEN_CONSTEXPR spvgen_member_t %s_members[] = {\n", name);
+
+    for (unsigned short i = 0; i < type->struct_type.member_count; ++i) {
+        fprintf(gen->out, "    { \"%s\", %u, %lu },\n", member_names[i], offsets[i], layouts[i].size);
+    }
+
+    fprintf(gen->out, "    { 0, 0, 0 },\n};\n\n");
+
+    return 0;
+}
+
+/*
+ *    Gets the descriptor kind of a variable's pointee type.
+ *
+ *    @param spv_t *spv               The spv_t struct to use.
+ *    @param _variable_t *variable    The variable.
+ *    @param _type_t *type            The pointee type, with arrays unwrapped.
+ *
+ *    @return const char *    The name of the descriptor kind.
+ */
+static const char *spvgen_kind(spv_t *spv, _variable_t *variable, _type_t *type) {
+    unsigned int value;
+
+    if (type == (_type_t *)0x0)
+        return "SPVGEN_DESCRIPTOR_OTHER";
+
+    if (variable->storage_class == 0xC || spv_get_decoration(spv, type->id, _DECORATION_BUFFER_BLOCK, &value))
+        return "SPVGEN_DESCRIPTOR_STORAGE_BUFFER";
+
+    if (variable->storage_class == 0x2)
+        return "SPVGEN_DESCRIPTOR_UNIFORM_BUFFER";
+
+    switch (type->type) {
+        case _TYPE_SAMPLED_IMAGE: {
+            return "SPVGEN_DESCRIPTOR_COMBINED_IMAGE_SAMPLER";
+        } break;
+
+        case _TYPE_IMAGE: {
+            return type->image_type.sampled == 2 ? "SPVGEN_DESCRIPTOR_STORAGE_IMAGE" : "SPVGEN_DESCRIPTOR_SAMPLED_IMAGE";
+        } break;
+
+        case _TYPE_SAMPLER: {
+            return "SPVGEN_DESCRIPTOR_SAMPLER";
+        } break;
+
+        default: {
+            return "SPVGEN_DESCRIPTOR_OTHER";
+        } break;
+    }
+}
+
+/*
+ *    Emits the reflection tables and block structs of one module.
+ *
+ *    @param _gen_t *gen    The generator state.
+ *
+ *    @return int    0 on success, -1 on failure.
+ */
+static int spvgen_emit_module(_gen_t *gen) {
+    spv_t *spv = gen->spv;
+    char   name[_GEN_NAME_SIZE];
+
+    fprintf(gen->out, "static SPVGEN_CONSTEXPR spvgen_binding_t %s_bindings[] = {\n", gen->prefix);
+
+    unsigned int bindings = 0;
+
+    for (unsigned long i = 0; i < spv->variables_size; ++i) {
+        _variable_t *variable = &spv->variables[i];
+        _type_t     *type     = spvgen_type(spv, variable->result);
+        unsigned int set      = 0;
+        unsigned int binding  = 0;
+        unsigned int count    = 1;
+
+        if (!spv_get_decoration(spv, variable->id, _DECORATION_BINDING, &binding))
+            continue;
+
+        spv_get_decoration(spv, variable->id, _DECORATION_DESCRIPTOR_SET, &set);
+
+        if (type != (_type_t *)0x0 && type->type == _TYPE_POINTER)
+            type = spvgen_type(spv, type->pointer_type.type);
+
+        if (type != (_type_t *)0x0 && type->type == _TYPE_ARRAY) {
+            count = spv_get_constant(spv, type->array_type.length);
+            type  = spvgen_type(spv, type->array_type.element_type);
+        } else if (type != (_type_t *)0x0 && type->type == _TYPE_RUNTIME_ARRAY) {
+            count = 0;
+            type  = spvgen_type(spv, type->runtime_array_type.element_type);
+        }
+
+        const char *variable_name = spv_get_name(spv, variable->id);
+
+        if (variable_name == (const char *)0x0 && type != (_type_t *)0x0)
+            variable_name = spv_get_name(spv, type->id);
+
+        spvgen_identifier(name, sizeof(name), variable_name, "binding", variable->id);
+
+        fprintf(gen->out, "    { \"%s\", %u, %u, %u, %s },\n", name, set, binding, count, spvgen_kind(spv, variable, type));
+
+        bindings++;
+    }
+
+    fprintf(gen->out, "    { 0, 0, 0, 0, SPVGEN_DESCRIPTOR_OTHER },\n};\n\n");
+    fprintf(gen->out, "enum { %s_binding_count = %u };\n\n", gen->prefix, bindings);
+
+    for (unsigned int storage = 0x1; storage <= 0x3; storage += 0x2) {
+        unsigned int locations = 0;
+
+        fprintf(gen->out, "static SPVGEN_CONSTEXPR spvgen_location_t %s_%s[] = {\n", gen->prefix, storage == 0x1 ? "inputs" : "outputs");
+
+        for (unsigned long i = 0; i < spv->variables_size; ++i) {
+            _variable_t *variable   = &spv->variables[i];
+            _type_t     *type       = spvgen_type(spv, variable->result);
+            unsigned int location   = 0;
+            unsigned int components = 1;
+
+            if (variable->storage_class != storage || !spv_get_decoration(spv, variable->id, _DECORATION_LOCATION, &location))
+                continue;
+
+            if (type != (_type_t *)0x0 && type->type == _TYPE_POINTER)
+                type = spvgen_type(spv, type->pointer_type.type);
+
+            if (type != (_type_t *)0x0 && type->type == _TYPE_VECTOR)
+                components = type->vector_type.component_count;
+
+            spvgen_identifier(name, sizeof(name), spv_get_name(spv, variable->id), "location", location);
+
+            fprintf(gen->out, "    { \"%s\", %u, %u },\n", name, location, components);
+
+            locations++;
+        }
+
+        fprintf(gen->out, "    { 0, 0, 0 },\n};\n\n");
+        fprintf(gen->out, "enum { %s_%s_count = %u };\n\n", gen->prefix, storage == 0x1 ? "input" : "output", locations);
+    }
+
+    for (unsigned long i = 0; i < spv->variables_size; ++i) {
+        _variable_t *variable = &spv->variables[i];
+        _type_t     *type     = spvgen_type(spv, variable->result);
+
+        if (variable->storage_class != 0x2 && variable->storage_class != 0x9 && variable->storage_class != 0xC)
+            continue;
+
+        if (type != (_type_t *)0x0 && type->type == _TYPE_POINTER)
+            type = spvgen_type(spv, type->pointer_type.type);
+
+        while (type != (_type_t *)0x0 && (type->type == _TYPE_ARRAY || type->type == _TYPE_RUNTIME_ARRAY))
+            type = spvgen_type(spv, type->type == _TYPE_ARRAY ? type->array_type.element_type : type->runtime_array_type.element_type);
+
+        if (type == (_type_t *)0x0 || type->type != _TYPE_STRUCT)
+            continue;
+
+        if (spvgen_emit_struct(gen, type->id, 0) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/*
+ *    Reads a whole file into memory.
+ *
+ *    @param const char *path       The path of the file.
+ *    @param unsigned long *size    Set to the size of the file.
+ *
+ *    @return char *    The file contents, or null on failure.
+ */
+static char *spvgen_read(const char *path, unsigned long *size) {
+    FILE *file = fopen(path, "rb");
+
+    if (file == (FILE *)0x0)
+        return (char *)0x0;
+
+    fseek(file, 0, SEEK_END);
+
+    *size = ftell(file);
+
+    fseek(file, 0, SEEK_SET);
+
+    char *data = (char *)malloc(*size ? *size : 1);
+
+    if (data != (char *)0x0 && fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = (char *)0x0;
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+/*
+ *    Gets the identifier prefix for a module from its file name. Only the
+ *    given extension is stripped, so shader.vert.spv becomes shader_vert.
+ *
+ *    @param const char *path         The path of the module.
+ *    @param const char *extension    The extension to strip.
+ *    @param char *buffer             The buffer to write to.
+ *    @param unsigned long size       The size of the buffer.
+ */
+static void spvgen_prefix(const char *path, const char *extension, char *buffer, unsigned long size) {
+    const char *base = strrchr(path, '/');
+    char        name[_GEN_NAME_SIZE];
+
+    base = base != (const char *)0x0 ? base + 1 : path;
+
+    snprintf(name, sizeof(name), "%s", base);
+
+    unsigned long length = strlen(name);
+    unsigned long strip  = strlen(extension);
+
+    if (length > strip && strcmp(name + length - strip, extension) == 0)
+        name[length - strip] = '\0';
+
+    spvgen_identifier(buffer, size, name, "shader", 0);
+}
+
+int main(int argc, char **argv) {
+    const char *output = (const char *)0x0;
+    FILE       *out    = stdout;
+    int         first  = 1;
+    int         status = 0;
+
+    if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+        output = argv[2];
+        first  = 3;
+    }
+
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-o output.h] shader.spv ...\n", argv[0]);
+        return 1;
+    }
+
+    if (output != (const char *)0x0) {
+        out = fopen(output, "w");
+
+        if (out == (FILE *)0x0) {
+            fprintf(stderr, "spvgen: failed to open %s\n", output);
+            return 1;
+        }
+    }
+
+    char guard[_GEN_NAME_SIZE];
+
+    if (output != (const char *)0x0)
+        spvgen_prefix(output, ".h", guard, sizeof(guard));
+    else
+        spvgen_prefix(argv[first], ".spv", guard, sizeof(guard));
+
+    for (char *c = guard; *c != '\0'; ++c) {
+        if (*c >= 'a' && *c <= 'z')
+            *c -= 'a' - 'A';
+    }
+
+    fprintf(out, "/*\n *    Generated by spvgen. Do not edit.\n */\n");
+    fprintf(out, "#ifndef _SPVGEN_%s_H\n#define _SPVGEN_%s_H\n\n", guard, guard);
+    fprintf(out, "#include <stddef.h>\n#include <stdint.h>\n\n");
+    fprintf(out, "#ifndef _SPVGEN_TYPES\n#define _SPVGEN_TYPES\n\n");
+    fprintf(out, "#ifdef __cplusplus\n"
+                 "#define SPVGEN_STATIC_ASSERT static_assert\n"
+                 "#define SPVGEN_CONSTEXPR     constexpr\n"
+                 "#else\n"
+                 "#define SPVGEN_STATIC_ASSERT _Static_assert\n"
+                 "#define SPVGEN_CONSTEXPR     const\n"
+                 "#endif\n\n");
+    fprintf(out, "typedef enum {\n"
+                 "    SPVGEN_DESCRIPTOR_OTHER = 0,\n"
+                 "    SPVGEN_DESCRIPTOR_UNIFORM_BUFFER,\n"
+                 "    SPVGEN_DESCRIPTOR_STORAGE_BUFFER,\n"
+                 "    SPVGEN_DESCRIPTOR_COMBINED_IMAGE_SAMPLER,\n"
+                 "    SPVGEN_DESCRIPTOR_SAMPLED_IMAGE,\n"
+                 "    SPVGEN_DESCRIPTOR_STORAGE_IMAGE,\n"
+                 "    SPVGEN_DESCRIPTOR_SAMPLER,\n"
+                 "} spvgen_descriptor_e;\n\n");
+    fprintf(out, "typedef struct {\n"
+                 "    const char          *name;\n"
+                 "    uint32_t             set;\n"
+                 "    uint32_t             binding;\n"
+                 "    uint32_t             count;\n"
+                 "    spvgen_descriptor_e  kind;\n"
+                 "} spvgen_binding_t;\n\n");
+    fprintf(out, "typedef struct {\n"
+                 "    const char *name;\n"
+                 "    uint32_t    location;\n"
+                 "    uint32_t    components;\n"
+                 "} spvgen_location_t;\n\n");
+    fprintf(out, "typedef struct {\n"
+                 "    const char *name;\n"
+                 "    uint32_t    offset;\n"
+                 "    uint32_t    size;\n"
+                 "} spvgen_member_t;\n\n");
+    fprintf(out, "#endif /* _SPVGEN_TYPES  */\n\n");
+
+    char (*prefixes)[_GEN_NAME_SIZE] = (char (*)[_GEN_NAME_SIZE])calloc(argc - first, _GEN_NAME_SIZE);
+
+    if (prefixes == (char (*)[_GEN_NAME_SIZE])0x0) {
+        fprintf(stderr, "spvgen: failed to allocate memory\n");
+        return 1;
+    }
+
+    for (int i = first; i < argc; ++i) {
+        unsigned long size   = 0;
+        char         *prefix = prefixes[i - first];
+
+        spvgen_prefix(argv[i], ".spv", prefix, _GEN_NAME_SIZE);
+
+        /* Identifiers are prefixed per module, so two modules with one prefix would clash.  */
+        int clash = 0;
+
+        for (int j = first; j < i; ++j) {
+            if (strcmp(prefixes[j - first], prefix) == 0)
+                clash = 1;
+        }
+
+        if (clash) {
+            fprintf(stderr, "spvgen: %s: prefix %s is already used by another module\n", argv[i], prefix);
+            status = 1;
+            continue;
+        }
+
+        char *data = spvgen_read(argv[i], &size);
+
+        if (data == (char *)0x0) {
+            fprintf(stderr, "spvgen: failed to read %s\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        spv_t *spv = spv_parse(data, size);
+
+        free(data);
+
+        if (spv == (spv_t *)0x0) {
+            fprintf(stderr, "spvgen: %s: %s\n", argv[i], spv_get_last_error());
+            status = 1;
+            continue;
+        }
+
+        _gen_t gen = { spv, out, prefix, (unsigned int *)0x0, 0 };
+
+        fprintf(out, "/* %s  */\n\n", argv[i]);
+
+        if (spvgen_emit_module(&gen) != 0) {
+            fprintf(stderr, "spvgen: %s: unsupported block layout\n", argv[i]);
+            status = 1;
+        }
+
+        free(gen.emitted);
+        spv_free(spv);
+    }
+
+    fprintf(out, "#endif /* _SPVGEN_%s_H  */\n", guard);
+
+    free(prefixes);
+
+    if (out != stdout)
+        fclose(out);
+
+    return status;
+}